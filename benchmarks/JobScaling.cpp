@@ -0,0 +1,149 @@
+#include "core/jobs/JobManager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace core::jobs;
+
+struct BenchState
+{
+	std::atomic<uint64_t> completed{0};
+	int work{0};
+	int fanOut{0};
+};
+
+void spin(int work)
+{
+	volatile uint32_t value = 1;
+	for (int i = 0; i < work; i++)
+	{
+		value = value * 1664525U + 1013904223U;
+	}
+}
+
+void leafJob(Job* /*job*/, void* data)
+{
+	auto* state = static_cast<BenchState*>(data);
+	spin(state->work);
+	state->completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+// submitted from main, spawns its children from inside a worker so they go through
+// the worker deques (and get stolen by everyone else)
+void rootJob(Job* /*job*/, void* data)
+{
+	auto* state = static_cast<BenchState*>(data);
+	for (int i = 0; i < state->fanOut; i++)
+	{
+		JobManager::submitJob(&leafJob, data);
+	}
+
+	spin(state->work);
+	state->completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto waitFor(BenchState& state, uint64_t total) -> double
+{
+	auto start = std::chrono::steady_clock::now();
+	while (state.completed.load(std::memory_order_relaxed) < total)
+	{
+		std::this_thread::yield();
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+		.count();
+}
+
+auto runExternal(int jobs, int work) -> double
+{
+	BenchState state;
+	state.work = work;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < jobs; i++)
+	{
+		JobManager::submitJob(&leafJob, &state);
+	}
+
+	waitFor(state, jobs);
+	auto elapsed =
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return jobs / elapsed;
+}
+
+auto runFanOut(int jobs, int work) -> double
+{
+	BenchState state;
+	state.work = work;
+	state.fanOut = 63;
+
+	int roots = std::max(1, jobs / (state.fanOut + 1));
+	uint64_t total = (uint64_t)roots * (state.fanOut + 1);
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < roots; i++)
+	{
+		JobManager::submitJob(&rootJob, &state);
+	}
+
+	waitFor(state, total);
+	auto elapsed =
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return (double)total / elapsed;
+}
+
+// usage: bench_jobs [jobs per run] [work per job (iterations)]
+auto main(int argc, const char** argv) -> int
+{
+	int jobs = argc >= 2 ? std::atoi(argv[1]) : 200000;
+	int work = argc >= 3 ? std::atoi(argv[2]) : 64;
+	int maxThreads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+	std::vector<int> threadCounts;
+	for (int count = 1; count < maxThreads; count *= 2)
+	{
+		threadCounts.push_back(count);
+	}
+	threadCounts.push_back(maxThreads);
+
+	std::cout << "jobs/sec, " << jobs << " jobs per run, " << work
+			  << " iterations of work per job\n\n";
+	std::cout << std::setw(8) << "threads" << std::setw(16) << "external" << std::setw(10)
+			  << "scale" << std::setw(16) << "fan-out" << std::setw(10) << "scale"
+			  << "\n";
+
+	double baseExternal = 0;
+	double baseFanOut = 0;
+
+	for (int count : threadCounts)
+	{
+		JobManager::initialize(count);
+
+		// warm up so thread creation and first touches don't end up in the numbers
+		runExternal(jobs / 10, work);
+
+		double external = runExternal(jobs, work);
+		double fanOut = runFanOut(jobs, work);
+
+		JobManager::shutdown();
+
+		if (baseExternal == 0)
+		{
+			baseExternal = external;
+			baseFanOut = fanOut;
+		}
+
+		std::cout << std::fixed << std::setprecision(0) << std::setw(8) << count
+				  << std::setw(16) << external << std::setw(9) << std::setprecision(2)
+				  << external / baseExternal << "x" << std::setw(16)
+				  << std::setprecision(0) << fanOut << std::setw(9)
+				  << std::setprecision(2) << fanOut / baseFanOut << "x\n";
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "core/jobs/JobManager.h"
+#include "core/jobs/Parallel.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace core::jobs;
+
+// best of a few runs, the first one usually pays for page faults
+template <typename Fn> auto measure(Fn&& fn, int runs = 5) -> double
+{
+	double best = 1e30;
+	for (int i = 0; i < runs; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		best = std::min(
+			best,
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+				.count());
+	}
+
+	return best;
+}
+
+// memory bound, almost nothing per element
+void light(std::vector<float>& out, const std::vector<float>& in, size_t first, size_t last)
+{
+	for (size_t i = first; i < last; i++)
+	{
+		out[i] = in[i] * 2.5F + 1.0F;
+	}
+}
+
+// compute bound, a couple hundred cycles per element
+void heavy(std::vector<float>& out, const std::vector<float>& in, size_t first, size_t last)
+{
+	for (size_t i = first; i < last; i++)
+	{
+		float value = in[i];
+		for (int j = 0; j < 16; j++)
+		{
+			value = std::sin(value) * std::sqrt(std::abs(value) + 1.0F);
+		}
+		out[i] = value;
+	}
+}
+
+auto sum(const std::vector<float>& in, size_t first, size_t last) -> double
+{
+	double result = 0;
+	for (size_t i = first; i < last; i++)
+	{
+		result += in[i];
+	}
+	return result;
+}
+
+void printRow(const char* name, size_t grain, double serial, double parallel)
+{
+	std::cout << std::setw(10) << name << std::setw(10);
+	if (grain == 0)
+	{
+		std::cout << "auto";
+	}
+	else
+	{
+		std::cout << grain;
+	}
+
+	std::cout << std::fixed << std::setprecision(3) << std::setw(12) << serial
+			  << std::setw(12) << parallel << std::setprecision(2) << std::setw(9)
+			  << serial / parallel << "x\n";
+}
+
+// usage: bench_parallel [elements] [worker threads]
+auto main(int argc, const char** argv) -> int
+{
+	size_t count = argc >= 2 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+	size_t threads = argc >= 3 ? std::strtoull(argv[2], nullptr, 10) : 0;
+
+	JobManager::initialize(threads);
+
+	std::vector<float> in(count);
+	std::vector<float> out(count);
+	std::iota(in.begin(), in.end(), 0.0F);
+
+	const size_t grains[] = {0, 64, 256, 1024, 4096, 16384, 65536};
+
+	std::cout << count << " elements, " << JobManager::threadCount() + 1
+			  << " threads (workers + caller), times in ms\n\n";
+	std::cout << std::setw(10) << "kernel" << std::setw(10) << "grain" << std::setw(12)
+			  << "serial" << std::setw(12) << "parallel" << std::setw(10) << "speedup"
+			  << "\n";
+
+	double serialLight = measure([&]() { light(out, in, 0, count); });
+	for (size_t grain : grains)
+	{
+		double parallel = measure(
+			[&]()
+			{
+				parallelFor(0, count, grain,
+							[&](size_t first, size_t last) { light(out, in, first, last); });
+			});
+		printRow("light", grain, serialLight, parallel);
+	}
+
+	// heavy is slow enough that a smaller slice tells the same story
+	size_t heavyCount = count / 8;
+	double serialHeavy = measure([&]() { heavy(out, in, 0, heavyCount); });
+	for (size_t grain : grains)
+	{
+		double parallel = measure(
+			[&]()
+			{
+				parallelFor(0, heavyCount, grain,
+							[&](size_t first, size_t last) { heavy(out, in, first, last); });
+			});
+		printRow("heavy", grain, serialHeavy, parallel);
+	}
+
+	volatile double sink = 0;
+	double serialSum = measure([&]() { sink = sum(in, 0, count); });
+	for (size_t grain : grains)
+	{
+		double parallel = measure(
+			[&]()
+			{
+				sink = parallelReduce(
+					0, count, grain, 0.0,
+					[&](size_t first, size_t last) { return sum(in, first, last); },
+					[](double a, double b) { return a + b; });
+			});
+		printRow("reduce", grain, serialSum, parallel);
+	}
+
+	JobManager::shutdown();
+	return 0;
+}
\ No newline at end of file
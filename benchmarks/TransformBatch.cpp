@@ -0,0 +1,141 @@
+#include "utils/math/Matrix4.h"
+#include "utils/math/TransformBatch.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// best of a few runs, the first one usually pays for page faults
+template <typename Fn> auto measure(Fn&& fn, int runs = 5) -> double
+{
+	double best = 1e30;
+	for (int i = 0; i < runs; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		best = std::min(
+			best,
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+				.count());
+	}
+
+	return best;
+}
+
+struct Local
+{
+	math::Vector3 position;
+	math::Quaternion rotation;
+	math::Vector3 scale;
+};
+
+// what Transform did per object before: three matrices, a vector of them and mulN
+auto perObject(const Local& local) -> math::Matrix4
+{
+	auto translation = math::Matrix4::translation(local.position);
+	auto rotation = math::Matrix4::rotation(local.rotation);
+	auto scaling = math::Matrix4::scaling(local.scale);
+
+	return math::Matrix4::multiply({translation, rotation, scaling});
+}
+
+auto maxDifference(const std::vector<math::Matrix4>& a, const std::vector<math::Matrix4>& b)
+	-> float
+{
+	float difference = 0;
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		for (int j = 0; j < 16; j++)
+		{
+			difference = std::max(difference, std::abs(a[i].raw[j / 4][j % 4] - b[i].raw[j / 4][j % 4]));
+		}
+	}
+	return difference;
+}
+
+// usage: bench_transforms [max transforms]
+auto main(int argc, const char** argv) -> int
+{
+	size_t limit = argc >= 2 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(-1.0F, 1.0F);
+
+	// a handful of parents shared by everyone, like a scene with some deep-ish groups
+	std::vector<math::Matrix4> parentPool(64);
+	for (auto& parent : parentPool)
+	{
+		parent = math::Matrix4::translation({unit(random) * 10, unit(random) * 10, unit(random) * 10});
+	}
+
+	std::cout << "batch width " << math::getTransformBatchWidth() << ", times in ms\n\n";
+	std::cout << std::setw(10) << "count" << std::setw(14) << "per object" << std::setw(14)
+			  << "composeTRS" << std::setw(12) << "batched" << std::setw(10) << "speedup"
+			  << std::setw(14) << "max diff" << "\n";
+
+	for (size_t count : {10000, 100000, 1000000})
+	{
+		if (count > limit)
+		{
+			break;
+		}
+
+		std::vector<Local> locals(count);
+		math::TransformBatch batch;
+		batch.resize(count);
+		std::vector<const math::Matrix4*> parents(count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			auto& local = locals[i];
+			local.position = {unit(random) * 100, unit(random) * 100, unit(random) * 100};
+
+			math::Quaternion rotation(unit(random), unit(random), unit(random), unit(random) + 2);
+			float length = std::sqrt(rotation.x * rotation.x + rotation.y * rotation.y +
+									 rotation.z * rotation.z + rotation.w * rotation.w);
+			local.rotation = math::Quaternion(rotation.x / length, rotation.y / length,
+											  rotation.z / length, rotation.w / length);
+			local.scale = {1 + unit(random) * 0.5F, 1 + unit(random) * 0.5F, 1 + unit(random) * 0.5F};
+
+			batch.set(i, local.position, local.rotation, local.scale);
+			parents[i] = &parentPool[random() % parentPool.size()];
+		}
+
+		std::vector<math::Matrix4> reference(count);
+		std::vector<math::Matrix4> scalar(count);
+		std::vector<math::Matrix4> batched(count);
+
+		double perObjectTime = measure(
+			[&]()
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					reference[i] = *parents[i] * perObject(locals[i]);
+				}
+			});
+
+		double scalarTime = measure(
+			[&]()
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					const auto& local = locals[i];
+					scalar[i] = *parents[i] * math::composeTRS(local.position, local.rotation, local.scale);
+				}
+			});
+
+		double batchedTime = measure([&]() { batch.computeWorld(parents.data(), batched.data()); });
+
+		std::cout << std::setw(10) << count << std::fixed << std::setprecision(3)
+				  << std::setw(14) << perObjectTime << std::setw(14) << scalarTime
+				  << std::setw(12) << batchedTime << std::setprecision(1) << std::setw(9)
+				  << perObjectTime / batchedTime << "x" << std::scientific << std::setprecision(2)
+				  << std::setw(14) << maxDifference(reference, batched) << std::defaultfloat
+				  << "\n";
+	}
+
+	return 0;
+}
@@ -58,6 +58,10 @@ namespace core
 
 		auto getSensorAspect() const -> float;
 
+		// as of the last update, tick thread only (the renderer goes through snapshots)
+		auto getView() const -> math::Matrix4;
+		auto getProjection() const -> math::Matrix4;
+
 	protected:
 		ProjectionType projectionType{ProjectionType::Perspective};
 
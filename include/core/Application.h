@@ -60,15 +60,12 @@ namespace core
 			return envInfo.get();
 		}
 
-		auto getFrameMemoryPool() -> jobs::FrameMemoryPool*
-		{
-			return frameMemoryPool.get();
-		}
+		// the current frame's arena, see JobManager::getFrameMemory for older frames
+		auto getFrameMemoryPool() -> jobs::FrameMemoryPool*;
 
 		[[nodiscard]] auto hasInit() const -> bool;
 
 	protected:
-		std::unique_ptr<jobs::FrameMemoryPool> frameMemoryPool;
 		std::unique_ptr<platform::Window> window;
 		platform::ApplicationInfo appInfo;
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "core/Transform.h"
+#include "core/ecs/Types.h"
 #include <memory>
 
 namespace core
@@ -7,6 +8,15 @@ namespace core
 	inline unsigned long component_id = 0;
     class Entity;
 
+	// one id per component class, from the same registry as ecs::typeID so both kinds
+	// share the id space and the limit. scene components never live in chunks, so
+	// there's no layout to register for them
+	template <typename T> auto componentTypeID() -> ecs::ComponentTypeID
+	{
+		static const ecs::ComponentTypeID id = ecs::internals::registerComponentType({});
+		return id;
+	}
+
 	class Component : public std::enable_shared_from_this<Component>
 	{
 	public:
@@ -56,6 +66,7 @@ namespace core
 	private:
 		bool _active{true};
 		unsigned long _id{0};
+		ecs::ComponentTypeID _typeID{0};
         Entity* _entity{nullptr};
 		Transform* _transform{nullptr};
 
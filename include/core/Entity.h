@@ -2,8 +2,11 @@
 #include "Application.h"
 #include "Component.h"
 #include "core/Transform.h"
+#include "core/ecs/World.h"
 #include <algorithm>
 #include <atomic>
+#include <bitset>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <utility>
@@ -14,6 +17,37 @@ namespace core
 	inline std::atomic<unsigned int> entity_id{0};
 
 	class Scene;
+	class Entity;
+
+	// refers to an entity in a scene without keeping it alive. once the entity is
+	// gone the scene hands out nullptr for it, even if the slot got reused since
+	struct EntityHandle
+	{
+		uint32_t index{0};
+		uint32_t generation{0};
+
+		[[nodiscard]] auto isValid() const -> bool
+		{
+			return generation != 0;
+		}
+
+		auto operator==(const EntityHandle& other) const -> bool
+		{
+			return index == other.index && generation == other.generation;
+		}
+
+		auto operator!=(const EntityHandle& other) const -> bool
+		{
+			return !(*this == other);
+		}
+	};
+
+	// added to an entity's row in the scene's ecs::World the first time it gets data
+	// components, so a query can get back to the entity (and its components) from there
+	struct EntityLink
+	{
+		Entity* entity{nullptr};
+	};
 
 	class Entity : public std::enable_shared_from_this<Entity>
 	{
@@ -23,6 +57,8 @@ namespace core
 		{
 		}
 
+		~Entity();
+
 		template <typename T, typename... Args> auto addComponent(Args&&... args) -> T*
 		{
 			static_assert(std::is_base_of_v<Component, T>,
@@ -32,6 +68,7 @@ namespace core
 			component->_entity = this;
 			component->_active = true;
 			component->_transform = &transform;
+			component->_typeID = componentTypeID<T>();
 
 			if (Application::main && Application::main->hasInit())
 			{
@@ -39,23 +76,44 @@ namespace core
 				component->start();
 			}
 
+			auto type = component->_typeID;
+			if (_componentIndex.size() <= type)
+			{
+				_componentIndex.resize(type + 1);
+			}
+
+			auto& slot = _componentIndex[type];
+			if (slot.count++ == 0)
+			{
+				slot.index = (uint32_t)_components.size();
+				_componentMask.set(type);
+			}
+
 			_components.push_back(std::unique_ptr<T>(component));
 			return component;
 		}
 
+		// lookups go by the exact type that was added, a subclass of T doesn't count
 		template <typename T> auto getComponent() const -> T*
 		{
 			static_assert(std::is_base_of_v<Component, T>,
 						  "T must be derived from Component");
 
-			for (const auto& component : _components)
+			auto type = componentTypeID<T>();
+			if (!_componentMask.test(type))
 			{
-				if (auto casted = dynamic_cast<T*>(component.get()))
-				{
-					return casted;
-				}
+				return nullptr;
 			}
-			return nullptr;
+
+			return static_cast<T*>(_components[_componentIndex[type].index].get());
+		}
+
+		template <typename T> auto hasComponent() const -> bool
+		{
+			static_assert(std::is_base_of_v<Component, T>,
+						  "T must be derived from Component");
+
+			return _componentMask.test(componentTypeID<T>());
 		}
 
 		template <typename T> auto getComponents() const -> std::vector<T*>
@@ -64,11 +122,25 @@ namespace core
 						  "T must be derived from Component");
 
 			std::vector<T*> components;
+			auto type = componentTypeID<T>();
+			if (!_componentMask.test(type))
+			{
+				return components;
+			}
+
+			const auto& slot = _componentIndex[type];
+			if (slot.count == 1)
+			{
+				components.push_back(static_cast<T*>(_components[slot.index].get()));
+				return components;
+			}
+
+			components.reserve(slot.count);
 			for (const auto& component : _components)
 			{
-				if (auto casted = dynamic_cast<T*>(component.get()))
+				if (component->_typeID == type)
 				{
-					components.push_back(casted);
+					components.push_back(static_cast<T*>(component.get()));
 				}
 			}
 			return components;
@@ -90,14 +162,10 @@ namespace core
 			static_assert(std::is_base_of_v<Component, T>,
 						  "T must be derived from Component");
 
-			auto it = std::find_if(
-				_components.begin(), _components.end(), [](const auto& component)
-				{ return dynamic_cast<T*>(component.get()) != nullptr; });
-
-			if (it != _components.end())
+			auto type = componentTypeID<T>();
+			if (_componentMask.test(type))
 			{
-				(*it)->setActive(false);
-				_components.erase(it);
+				_removeComponentAt(_componentIndex[type].index);
 			}
 		}
 
@@ -106,18 +174,11 @@ namespace core
 			static_assert(std::is_base_of_v<Component, T>,
 						  "T must be derived from Component");
 
-			_components.erase(
-				std::remove_if(_components.begin(), _components.end(),
-							   [](const auto& component)
-							   {
-								   if (auto casted = dynamic_cast<T*>(component.get()))
-								   {
-									   casted->setActive(false);
-									   return true;
-								   }
-								   return false;
-							   }),
-				_components.end());
+			auto type = componentTypeID<T>();
+			while (_componentMask.test(type))
+			{
+				_removeComponentAt(_componentIndex[type].index);
+			}
 		}
 
 		void removeAllComponents()
@@ -127,6 +188,51 @@ namespace core
 				component->setActive(false);
 			}
 			_components.clear();
+			_componentIndex.clear();
+			_componentMask.reset();
+		}
+
+		// plain data components, kept in the scene's ecs::World next to everything
+		// spawned straight into it, so systems running over them with Scene::each see
+		// this entity too. only works once the entity is part of a scene
+		template <typename T, typename... Args> auto addData(Args&&... args) -> T*
+		{
+			if (_world == nullptr)
+			{
+				log_error("entity \"%s\" isn't in a scene, can't add data to it", _entityName.c_str());
+				return nullptr;
+			}
+
+			if (!_world->isAlive(_dataID))
+			{
+				_dataID = _world->create(EntityLink{this});
+			}
+
+			return _world->add<T>(_dataID, std::forward<Args>(args)...);
+		}
+
+		template <typename T> auto getData() const -> T*
+		{
+			return _world != nullptr ? _world->get<T>(_dataID) : nullptr;
+		}
+
+		template <typename T> auto hasData() const -> bool
+		{
+			return _world != nullptr && _world->has<T>(_dataID);
+		}
+
+		template <typename T> void removeData()
+		{
+			if (_world != nullptr)
+			{
+				_world->remove<T>(_dataID);
+			}
+		}
+
+		// invalid until the first addData
+		auto getDataID() const -> ecs::EntityID
+		{
+			return _dataID;
 		}
 
 		auto addChild(std::string name = "Entity", char entityTag = 0) -> Entity*
@@ -134,6 +240,7 @@ namespace core
 			auto* child = new Entity(std::move(name), entityTag);
 			child->_parent = this;
 			child->_active = true;
+			child->_setScene(_scene);
 
 			_children.push_back(std::shared_ptr<Entity>(child));
 			return child;
@@ -143,8 +250,11 @@ namespace core
 		{
 			entity->_parent = this;
 			entity->_active = true;
+			entity->_setScene(_scene);
+			entity->transform._markDirty();
 
 			_children.push_back(std::shared_ptr<Entity>(entity));
+			_hierarchyChanged();
 			return entity;
 		}
 
@@ -153,8 +263,11 @@ namespace core
 			if (child->isOrphan() && !isDescendant(child.get()))
 			{
 				child->_parent = this;
+				child->_setScene(_scene);
+				child->transform._markDirty();
 
 				_children.push_back(child);
+				_hierarchyChanged();
 			}
 			else
 			{
@@ -162,29 +275,9 @@ namespace core
 			}
 		}
 
-		auto getChild(unsigned int id) const -> Entity*
-		{
-			for (const auto& child : _children)
-			{
-				if (child->_entityID == id)
-				{
-					return child.get();
-				}
-			}
-			return nullptr;
-		}
-
-		auto getChild(const std::string& name) const -> Entity*
-		{
-			for (const auto& child : _children)
-			{
-				if (child->_entityName == name)
-				{
-					return child.get();
-				}
-			}
-			return nullptr;
-		}
+		// through the scene's indices when there is one
+		auto getChild(unsigned int id) const -> Entity*;
+		auto getChild(const std::string& name) const -> Entity*;
 
 		auto getChildren(unsigned char entityTag) const -> std::vector<Entity*>
 		{
@@ -201,62 +294,62 @@ namespace core
 
 		void removeChild(Entity* child)
 		{
-
 			_children.remove_if(
 				[child](const auto& c)
 				{
 					if (c.get() == child)
 					{
-						c->setActive(false);
+						_detach(c.get());
 						return true;
 					}
 					return false;
 				});
+			_hierarchyChanged();
 		}
 
 		void removeChild(unsigned int id)
 		{
-
 			_children.remove_if(
 				[id](const auto& child)
 				{
 					if (child->_entityID == id)
 					{
-						child->setActive(false);
+						_detach(child.get());
 						return true;
 					}
 					return false;
 				});
+			_hierarchyChanged();
 		}
 
 		void removeChild(const std::string& name)
 		{
-
 			_children.remove_if(
 				[&name](const auto& child)
 				{
 					if (child->_entityName == name)
 					{
-						child->setActive(false);
+						_detach(child.get());
 						return true;
 					}
 					return false;
 				});
+			_hierarchyChanged();
 		}
 
 		void removeChildren(char entityTag)
 		{
-
 			_children.remove_if(
 				[entityTag](const auto& child)
 				{
 					if (child->_entityTag == entityTag)
 					{
-						child->setActive(false);
+						_detach(child.get());
 						return true;
 					}
 					return false;
 				});
+			_hierarchyChanged();
 		}
 
 		void setParent(Entity* parent)
@@ -279,19 +372,13 @@ namespace core
 				{ return child.get() == entity || child->isDescendant(entity); });
 		}
 
-		void setTag(char entityTag)
-		{
-			_entityTag = entityTag;
-		}
+		void setTag(char entityTag);
 		auto getTag() const -> unsigned char
 		{
 			return _entityTag;
 		}
 
-		void setName(const std::string& name)
-		{
-			_entityName = name;
-		}
+		void setName(const std::string& name);
 		auto getName() const -> const std::string&
 		{
 			return _entityName;
@@ -302,6 +389,12 @@ namespace core
 			return _entityID;
 		}
 
+		// invalid until the entity is in a scene
+		auto getHandle() const -> EntityHandle
+		{
+			return _handle;
+		}
+
 		void setActive(bool active)
 		{
 			_active = active;
@@ -351,10 +444,9 @@ namespace core
 			return result;
 		}
 
+		// transforms aren't updated here, the scene does all of them in one pass
 		void tick()
 		{
-			transform.update();
-
 			if (!_active)
 			{
 				return;
@@ -422,16 +514,84 @@ namespace core
 		Transform transform;
 
 	private:
+		// where the (or one of the) components of a type sits in _components
+		struct ComponentSlot
+		{
+			uint32_t index{0};
+			uint32_t count{0};
+		};
+
 		std::vector<std::unique_ptr<Component>> _components;
+		std::vector<ComponentSlot> _componentIndex; // by componentTypeID
+		std::bitset<ecs::MaxComponentTypes> _componentMask;
 		std::list<std::shared_ptr<Entity>> _children;
 		Entity* _parent{nullptr};
 		std::string _entityName;
 		Scene* _scene{nullptr};
+		ecs::World* _world{nullptr};
+		ecs::EntityID _dataID;
+		EntityHandle _handle;
+		uint32_t _nameSlot{0}; // where it sits in the scene's name/tag indices
+		uint32_t _tagSlot{0};
 		unsigned char _entityTag{0};
 		unsigned int _entityID{0};
 		bool _active{true};
 		bool _visible{true};
 
+		// registers with the new scene (and lets go of the old one), children included
+		void _setScene(Scene* scene);
+
+		// anything added, removed or moved in the hierarchy under this entity
+		void _hierarchyChanged();
+
+		// swaps the last component into its place, so update order isn't kept
+		void _removeComponentAt(uint32_t index)
+		{
+			_components[index]->setActive(false);
+
+			auto removed = std::move(_components[index]);
+			auto last = (uint32_t)_components.size() - 1;
+			if (index != last)
+			{
+				_components[index] = std::move(_components[last]);
+
+				auto& moved = _componentIndex[_components[index]->_typeID];
+				if (moved.index == last)
+				{
+					moved.index = index;
+				}
+			}
+			_components.pop_back();
+
+			auto type = removed->_typeID;
+			auto& slot = _componentIndex[type];
+			if (--slot.count == 0)
+			{
+				_componentMask.reset(type);
+			}
+			else if (slot.index == index)
+			{
+				// that was the one the index pointed at, any other will do
+				for (uint32_t i = 0; i < _components.size(); i++)
+				{
+					if (_components[i]->_typeID == type)
+					{
+						slot.index = i;
+						break;
+					}
+				}
+			}
+		}
+
+		// a removed child stops being part of the scene too, whoever still holds on to
+		// it gets a plain orphan that lookups don't find anymore
+		static void _detach(Entity* child)
+		{
+			child->setActive(false);
+			child->_parent = nullptr;
+			child->_setScene(nullptr);
+		}
+
 		void _removeChildPriv(Entity* child)
 		{
 			_children.remove_if(
@@ -444,8 +604,10 @@ namespace core
 					}
 					return false;
 				});
+			_hierarchyChanged();
 		}
 
 		friend Scene;
+		friend class TransformHierarchy;
 	};
 }
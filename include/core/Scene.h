@@ -2,7 +2,10 @@
 #include "components/graphics/Camera.h"
 #include "core/Component.h"
 #include "core/Entity.h"
+#include "core/TransformHierarchy.h"
+#include "core/ecs/World.h"
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace core
@@ -18,15 +21,55 @@ namespace core
 		auto addEntity(std::string name = "Entity", char tag = 0) -> Entity*;
 
 		auto addEntity(Entity* entity) -> void;
+
+		// these look through the whole scene, children included. with more than one
+		// entity of that name, which one comes back isn't defined
 		auto getEntity(unsigned int id) -> Entity*;
 		auto getEntity(const std::string& name) -> Entity*;
 		auto getEntities(const char& tag) -> std::vector<Entity*>;
 
+		[[nodiscard]] auto getHierarchy() const -> const TransformHierarchy&
+		{
+			return _hierarchy;
+		}
+
+		// nullptr once the entity is gone
+		auto getEntity(EntityHandle handle) -> Entity*;
+		[[nodiscard]] auto isValid(EntityHandle handle) const -> bool
+		{
+			return handle.index < _slots.size() && _slots[handle.index].generation == handle.generation;
+		}
+
 		auto removeEntity(Entity* entity) -> void;
+		auto removeEntity(EntityHandle handle) -> void;
 		auto removeEntity(unsigned int id) -> void;
 		auto removeEntity(const std::string& name) -> void;
 		auto removeEntities(const char& tag) -> void;
 
+		// data-only entities straight in the scene's chunks, no Entity object behind
+		// them. for the things there are far too many of to each get scripts
+		template <typename... Ts> auto spawn(Ts&&... components) -> ecs::EntityID
+		{
+			return _world.create(std::forward<Ts>(components)...);
+		}
+
+		void despawn(ecs::EntityID entity)
+		{
+			_world.destroy(entity);
+		}
+
+		// runs fn over everything in the scene with all of Ts, spawned entities and
+		// Entity::addData alike. fn takes (Ts&...) or (ecs::EntityID, Ts&...)
+		template <typename... Ts, typename Fn> void each(Fn&& fn)
+		{
+			_world.each<Ts...>(std::forward<Fn>(fn));
+		}
+
+		auto getWorld() -> ecs::World&
+		{
+			return _world;
+		}
+
 		void registerCamera(Camera* camera);
 		void unregisterCamera(Camera* camera);
 		void requestCameraReorder();
@@ -42,6 +85,7 @@ namespace core
 		void clear()
 		{
 			_entities.clear();
+			_world.clear();
 		}
 
 		[[nodiscard]] auto getEntities() const -> std::vector<Entity*>;
@@ -57,9 +101,39 @@ namespace core
 		}
 
 	private:
+		struct EntitySlot
+		{
+			Entity* entity{nullptr};
+			uint32_t generation{1};
+		};
+
+		// every entity in the scene, children included. kept up to date by Entity
+		// itself as it joins, leaves, gets renamed or retagged
+		void _registerEntity(Entity* entity);
+		void _unregisterEntity(Entity* entity);
+		void _renameEntity(Entity* entity, const std::string& name);
+		void _retagEntity(Entity* entity, unsigned char tag);
+		void _indexName(Entity* entity);
+		void _unindexName(Entity* entity);
+		void _indexTag(Entity* entity);
+		void _unindexTag(Entity* entity);
+		auto _findChild(const Entity* parent, const std::string& name) -> Entity*;
+
+		std::vector<EntitySlot> _slots;
+		std::vector<uint32_t> _freeSlots;
+		std::unordered_map<unsigned int, Entity*> _byID;
+		std::unordered_map<std::string, std::vector<Entity*>> _byName;
+		std::unordered_map<unsigned char, std::vector<Entity*>> _byTag;
+
+		TransformHierarchy _hierarchy;
+
+		// before _entities, entities let go of their rows in it when they're destroyed
+		ecs::World _world;
 		std::vector<std::unique_ptr<Entity>> _entities;
 		std::vector<core::Camera*> _cameras;
 		unsigned short _id{0};
 		std::string _name;
+
+		friend Entity;
 	};
 }
\ No newline at end of file
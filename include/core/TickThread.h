@@ -1,14 +1,76 @@
 #pragma once
 #include "components/core/LuaScriptEngine.h"
+#include "input/InputEvent.h"
 #include "platform/Thread.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
 
 namespace core
 {
+	// runs the simulation at a fixed rate. real time goes into an accumulator and
+	// gets consumed in fixed steps, so a slow frame means a few ticks back to back
+	// (up to the catch-up cap) and a fast machine sleeps instead of spinning
 	class TickThread : public platform::Thread
 	{
 	public:
 		void init() override;
 		void shutdown() override;
 		void update() override;
+
+		// 0 goes back to ticking as fast as possible, with no pacing at all
+		static void setTickRate(double hz);
+		static auto getTickRate() -> double;
+
+		// seconds per tick, what simulation code should step by
+		static auto getFixedDelta() -> double;
+
+		// ticks run back to back before falling behind is accepted and the rest of
+		// the backlog is dropped (so one long hitch doesn't become a spiral)
+		static void setMaxCatchUpSteps(uint32_t steps);
+
+		// the last stretch before a tick is due gets spun out instead of slept,
+		// os sleeps tend to overshoot by a good fraction of a millisecond
+		static void setSpinWindow(std::chrono::microseconds window);
+
+		// how far along real time is between the last tick and the next one, 0..1.
+		// the renderer blends the previous and current simulation states with this
+		static auto getAlpha() -> float;
+
+		static auto getTickCount() -> uint64_t
+		{
+			return tickCount.load(std::memory_order_relaxed);
+		}
+
+		// input that came in since the previous tick, tick thread only. catch-up ticks
+		// after the first one in an update get an empty list
+		static auto getInputEvents() -> const std::vector<InputEvent>&
+		{
+			return inputEvents;
+		}
+
+		// time thrown away by the catch-up cap, in seconds
+		static auto getDroppedTime() -> double
+		{
+			return (double)droppedTime.load(std::memory_order_relaxed) * 1e-9;
+		}
+
+	private:
+		void waitUntil(int64_t deadline);
+
+		int64_t _previous{0};
+		int64_t _accumulator{0};
+
+		inline static std::atomic<int64_t> step{1000000000 / 60}; // ns, 0 = unpaced
+		inline static std::atomic<uint32_t> maxCatchUpSteps{5};
+		inline static std::atomic<int64_t> spinWindow{1000000}; // ns
+
+		// published at the end of every update for the render side
+		inline static std::atomic<int64_t> lastTickTime{0};
+		inline static std::atomic<uint64_t> tickCount{0};
+		inline static std::atomic<uint64_t> droppedTime{0};
+
+		inline static std::vector<InputEvent> inputEvents;
 	};
-}
\ No newline at end of file
+}
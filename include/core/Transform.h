@@ -6,6 +6,7 @@
 namespace core
 {
 	class Entity;
+	class TransformHierarchy;
 
 	struct Transform
 	{
@@ -81,9 +82,13 @@ namespace core
 		math::Vector3 _cachedWorldPos;
 		math::Quaternion _cachedWorldRot;
 
+		auto _getParent() const -> Entity*;
 		void _markDirty();
 		void _recomputeWorldMatrix();
+		void _applyParent(const math::Matrix4& parentWorld);
+		void _setWorld(const math::Matrix4& world);
 
 		friend class core::Entity;
+		friend class TransformHierarchy;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace core
+{
+	class Entity;
+	struct Transform;
+
+	// a scene's transforms flattened breadth first: every depth level comes right
+	// after the one above it and every node knows its parent's index, so bringing
+	// the world matrices up to date is one pass from the top down instead of a walk
+	// through the entities. a node is only recomputed if it was moved itself or its
+	// parent got recomputed earlier in the same pass, so anything that sat still
+	// costs a flag check. levels are independent inside, big ones get split across
+	// the workers
+	class TransformHierarchy
+	{
+	public:
+		// something got added, removed or reparented, rebuilt on the next update
+		void invalidate()
+		{
+			_stale = true;
+		}
+
+		// tick thread, once per tick after everything that moves things around ran
+		void update(const std::vector<std::unique_ptr<Entity>>& roots);
+
+		[[nodiscard]] auto size() const -> size_t
+		{
+			return _transforms.size();
+		}
+
+		[[nodiscard]] auto getDepth() const -> size_t
+		{
+			return _levels.empty() ? 0 : _levels.size() - 1;
+		}
+
+		// levels smaller than this aren't worth waking anybody up for
+		static constexpr size_t ParallelThreshold = 4096;
+		static constexpr size_t ParallelGrain = 1024;
+
+		// transforms that go through the batched kernel together
+		static constexpr size_t BatchSize = 64;
+
+	private:
+		static constexpr uint32_t NoParent = UINT32_MAX;
+
+		void _rebuild(const std::vector<std::unique_ptr<Entity>>& roots);
+		void _updateRange(size_t begin, size_t end);
+
+		std::vector<Transform*> _transforms;
+		std::vector<uint32_t> _parents;
+		std::vector<uint8_t> _changed; // recomputed during this pass
+		std::vector<size_t> _levels;	// where each level starts, plus the end
+
+		// only kept around for the capacity
+		std::vector<Entity*> _entities;
+
+		bool _stale{true};
+	};
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "core/ecs/Types.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace core::ecs
+{
+	class World;
+
+	// every entity with exactly the same set of components. they're stored in chunks
+	// of ChunkSize bytes, each one split into one array per component (plus one for
+	// the entity ids), so walking a component means walking a plain array. rows are
+	// kept packed, removing one moves the last row into its place
+	class Archetype
+	{
+	public:
+		static constexpr size_t ChunkSize = 16 * 1024;
+
+		Archetype(const Signature& signature);
+		~Archetype();
+
+		Archetype(const Archetype&) = delete;
+		auto operator=(const Archetype&) -> Archetype& = delete;
+
+		[[nodiscard]] auto getSignature() const -> const Signature&
+		{
+			return _signature;
+		}
+
+		[[nodiscard]] auto has(ComponentTypeID type) const -> bool
+		{
+			return _signature.test(type);
+		}
+
+		// entities in the whole archetype
+		[[nodiscard]] auto size() const -> size_t
+		{
+			return _count;
+		}
+
+		// rows per chunk
+		[[nodiscard]] auto getCapacity() const -> uint32_t
+		{
+			return _capacity;
+		}
+
+		[[nodiscard]] auto getChunkCount() const -> size_t
+		{
+			return (_count + _capacity - 1) / _capacity;
+		}
+
+		// rows used in that chunk, every chunk but the last one is full
+		[[nodiscard]] auto getChunkSize(size_t chunk) const -> uint32_t
+		{
+			size_t first = chunk * _capacity;
+			return (uint32_t)std::min<size_t>(_capacity, _count - first);
+		}
+
+		[[nodiscard]] auto getEntities(size_t chunk) const -> EntityID*
+		{
+			return reinterpret_cast<EntityID*>(_chunks[chunk]);
+		}
+
+		// nullptr if this archetype doesn't have the component
+		[[nodiscard]] auto getColumn(size_t chunk, ComponentTypeID type) const -> void*
+		{
+			auto column = _columnOf[type];
+			if (column == NoColumn)
+			{
+				return nullptr;
+			}
+
+			return _chunks[chunk] + _columns[column].offset;
+		}
+
+		template <typename T> [[nodiscard]] auto getColumn(size_t chunk) const -> T*
+		{
+			return static_cast<T*>(getColumn(chunk, typeID<T>()));
+		}
+
+		[[nodiscard]] auto getComponent(uint32_t row, ComponentTypeID type) const -> void*
+		{
+			const auto& column = _columns[_columnOf[type]];
+			return _chunks[row / _capacity] + column.offset + (size_t)(row % _capacity) * column.info->size;
+		}
+
+		[[nodiscard]] auto getEntity(uint32_t row) const -> EntityID
+		{
+			return getEntities(row / _capacity)[row % _capacity];
+		}
+
+	private:
+		struct Column
+		{
+			ComponentTypeID type{0};
+			size_t offset{0};
+			const ComponentInfo* info{nullptr};
+		};
+
+		static constexpr uint8_t NoColumn = 0xff;
+
+		// a new row at the end, components left unconstructed
+		auto _allocate(EntityID entity) -> uint32_t;
+
+		// fills the hole at `row` (already destroyed or moved out) with the last row.
+		// returns whoever got moved into it, or an invalid id if it was the last one
+		auto _removeRow(uint32_t row) -> EntityID;
+
+		void _destroyRow(uint32_t row);
+		void _clear();
+
+		Signature _signature;
+		std::vector<Column> _columns;
+		std::array<uint8_t, MaxComponentTypes> _columnOf;
+
+		uint32_t _capacity{0};
+		size_t _chunkBytes{ChunkSize};
+		size_t _count{0};
+		std::vector<std::byte*> _chunks;
+
+		// archetype you end up in when adding/removing one component from this one,
+		// filled in as they get used
+		std::unordered_map<ComponentTypeID, Archetype*> _addEdges;
+		std::unordered_map<ComponentTypeID, Archetype*> _removeEdges;
+
+		friend class World;
+	};
+}
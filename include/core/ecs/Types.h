@@ -0,0 +1,114 @@
+#pragma once
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace core::ecs
+{
+	using ComponentTypeID = uint16_t;
+
+	constexpr size_t MaxComponentTypes = 128;
+	constexpr size_t MaxComponentAlignment = 64;
+
+	// which component types an archetype (or a query) is made of
+	using Signature = std::bitset<MaxComponentTypes>;
+
+	// an entity in a World. generation 0 is never handed out, so a default one is
+	// never alive
+	struct EntityID
+	{
+		uint32_t index{0};
+		uint32_t generation{0};
+
+		[[nodiscard]] auto isValid() const -> bool
+		{
+			return generation != 0;
+		}
+
+		auto operator==(const EntityID& other) const -> bool
+		{
+			return index == other.index && generation == other.generation;
+		}
+
+		auto operator!=(const EntityID& other) const -> bool
+		{
+			return !(*this == other);
+		}
+	};
+
+	// what a chunk needs to move a component around without knowing its type. a null
+	// move means plain bytes, memcpy and forget about it (destroy is null then too)
+	struct ComponentInfo
+	{
+		size_t size{0};
+		size_t alignment{0};
+
+		// move-constructs into destination and destroys source
+		void (*move)(void* destination, void* source){nullptr};
+		void (*destroy)(void* component){nullptr};
+	};
+
+	namespace internals
+	{
+		auto registerComponentType(const ComponentInfo& info) -> ComponentTypeID;
+
+		template <typename T> auto makeComponentInfo() -> ComponentInfo
+		{
+			ComponentInfo info;
+			info.size = sizeof(T);
+			info.alignment = alignof(T);
+
+			if constexpr (!std::is_trivially_copyable_v<T> || !std::is_trivially_destructible_v<T>)
+			{
+				info.move = [](void* destination, void* source)
+				{
+					new (destination) T(std::move(*static_cast<T*>(source)));
+					static_cast<T*>(source)->~T();
+				};
+				info.destroy = [](void* component) { static_cast<T*>(component)->~T(); };
+			}
+
+			return info;
+		}
+	}
+
+	auto getComponentInfo(ComponentTypeID type) -> const ComponentInfo&;
+	auto getComponentTypeCount() -> size_t;
+
+	// ids are handed out the first time a type is used, so they're only stable for
+	// the lifetime of the process. never save them anywhere
+	template <typename T> auto typeID() -> ComponentTypeID
+	{
+		using Type = std::remove_cv_t<std::remove_reference_t<T>>;
+		static_assert(std::is_move_constructible_v<Type>, "components have to be movable");
+		static_assert(alignof(Type) <= MaxComponentAlignment, "component is aligned too strictly");
+
+		static const ComponentTypeID id =
+			internals::registerComponentType(internals::makeComponentInfo<Type>());
+		return id;
+	}
+
+	inline void moveComponent(const ComponentInfo& info, void* destination, void* source)
+	{
+		if (info.move != nullptr)
+		{
+			info.move(destination, source);
+		}
+		else
+		{
+			std::memcpy(destination, source, info.size);
+		}
+	}
+
+	inline void destroyComponent(const ComponentInfo& info, void* component)
+	{
+		if (info.destroy != nullptr)
+		{
+			info.destroy(component);
+		}
+	}
+}
@@ -0,0 +1,212 @@
+#pragma once
+#include "core/ecs/Archetype.h"
+#include "core/log.h"
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace core::ecs
+{
+	// plain data entities, stored by archetype. meant for the things there are tens of
+	// thousands of (particles, projectiles, crowds) that only need a few fields and a
+	// system running over all of them, gameplay objects with scripts stay core::Entity.
+	// not thread safe, and nothing can be created, destroyed, added or removed while
+	// an each() is running
+	class World
+	{
+	public:
+		World();
+		~World();
+
+		World(const World&) = delete;
+		auto operator=(const World&) -> World& = delete;
+
+		auto create() -> EntityID;
+
+		template <typename... Ts> auto create(Ts&&... components) -> EntityID
+		{
+			Signature signature;
+			(signature.set(typeID<Ts>()), ...);
+
+			if (!_canChange())
+			{
+				return {};
+			}
+
+			auto entity = _newID();
+			auto* archetype = _getArchetype(signature);
+			auto& record = _records[entity.index];
+			record.archetype = archetype;
+			record.row = archetype->_allocate(entity);
+
+			(new (archetype->getComponent(record.row, typeID<Ts>()))
+				 std::decay_t<Ts>(std::forward<Ts>(components)),
+			 ...);
+
+			return entity;
+		}
+
+		void destroy(EntityID entity);
+
+		[[nodiscard]] auto isAlive(EntityID entity) const -> bool
+		{
+			return entity.index < _records.size() &&
+				   _records[entity.index].generation == entity.generation;
+		}
+
+		// replaces it if the entity already had one
+		template <typename T, typename... Args> auto add(EntityID entity, Args&&... args) -> T*
+		{
+			if (!isAlive(entity))
+			{
+				return nullptr;
+			}
+
+			auto type = typeID<T>();
+			const auto& record = _records[entity.index];
+			if (record.archetype->has(type))
+			{
+				auto* component = static_cast<T*>(record.archetype->getComponent(record.row, type));
+				*component = T(std::forward<Args>(args)...);
+				return component;
+			}
+
+			void* slot = _addComponent(entity, type);
+			return slot != nullptr ? new (slot) T(std::forward<Args>(args)...) : nullptr;
+		}
+
+		template <typename T> void remove(EntityID entity)
+		{
+			if (isAlive(entity) && _records[entity.index].archetype->has(typeID<T>()))
+			{
+				_removeComponent(entity, typeID<T>());
+			}
+		}
+
+		template <typename T> [[nodiscard]] auto get(EntityID entity) const -> T*
+		{
+			if (!isAlive(entity))
+			{
+				return nullptr;
+			}
+
+			auto type = typeID<T>();
+			const auto& record = _records[entity.index];
+			return record.archetype->has(type)
+					   ? static_cast<T*>(record.archetype->getComponent(record.row, type))
+					   : nullptr;
+		}
+
+		template <typename T> [[nodiscard]] auto has(EntityID entity) const -> bool
+		{
+			return isAlive(entity) && _records[entity.index].archetype->has(typeID<T>());
+		}
+
+		// fn(Ts&...) or fn(EntityID, Ts&...) for every entity that has all of Ts, a
+		// chunk at a time
+		template <typename... Ts, typename Fn> void each(Fn&& fn)
+		{
+			eachChunk<Ts...>(
+				[&fn](uint32_t count, EntityID* entities, Ts*... columns)
+				{
+					for (uint32_t i = 0; i < count; i++)
+					{
+						if constexpr (std::is_invocable_v<Fn&, EntityID, Ts&...>)
+						{
+							fn(entities[i], columns[i]...);
+						}
+						else
+						{
+							fn(columns[i]...);
+						}
+					}
+				});
+		}
+
+		// fn(count, EntityID*, Ts*...) once per chunk, for anything that wants the
+		// arrays themselves (simd, handing chunks out to jobs)
+		template <typename... Ts, typename Fn> void eachChunk(Fn&& fn)
+		{
+			Signature signature;
+			(signature.set(typeID<Ts>()), ...);
+
+			_iterating++;
+			for (auto* archetype : _match(signature))
+			{
+				size_t chunks = archetype->getChunkCount();
+				for (size_t chunk = 0; chunk < chunks; chunk++)
+				{
+					fn(archetype->getChunkSize(chunk), archetype->getEntities(chunk),
+					   archetype->template getColumn<Ts>(chunk)...);
+				}
+			}
+			_iterating--;
+		}
+
+		// how many entities have all of Ts
+		template <typename... Ts> [[nodiscard]] auto count() -> size_t
+		{
+			Signature signature;
+			(signature.set(typeID<Ts>()), ...);
+
+			size_t total = 0;
+			for (auto* archetype : _match(signature))
+			{
+				total += archetype->size();
+			}
+			return total;
+		}
+
+		[[nodiscard]] auto size() const -> size_t
+		{
+			return _alive;
+		}
+
+		[[nodiscard]] auto getArchetypes() const -> const std::vector<Archetype*>&
+		{
+			return _archetypeList;
+		}
+
+		void clear();
+
+	private:
+		struct Record
+		{
+			Archetype* archetype{nullptr};
+			uint32_t row{0};
+			uint32_t generation{1};
+		};
+
+		// archetypes that have (at least) everything in the signature. new archetypes
+		// only ever get appended, so each query just checks the ones it hasn't seen
+		struct Query
+		{
+			std::vector<Archetype*> archetypes;
+			size_t checked{0};
+		};
+
+		auto _newID() -> EntityID;
+		auto _canChange() const -> bool;
+		auto _getArchetype(const Signature& signature) -> Archetype*;
+		auto _match(const Signature& signature) -> const std::vector<Archetype*>&;
+
+		// moves the entity over, whatever `to` has that it didn't is left unconstructed
+		void _move(EntityID entity, Archetype* to);
+		auto _addComponent(EntityID entity, ComponentTypeID type) -> void*;
+		void _removeComponent(EntityID entity, ComponentTypeID type);
+
+		std::vector<Record> _records;
+		std::vector<uint32_t> _freeList;
+		size_t _alive{0};
+
+		std::unordered_map<Signature, std::unique_ptr<Archetype>> _archetypes;
+		std::vector<Archetype*> _archetypeList;
+		Archetype* _empty{nullptr};
+
+		std::unordered_map<Signature, Query> _queries;
+		uint32_t _iterating{0};
+	};
+}
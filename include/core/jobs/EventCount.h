@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#ifndef __linux__
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace core::jobs
+{
+	// lets threads sleep until "something changed" without a lock on the fast path.
+	// a waiter registers first, checks its condition again and only then sleeps, so a
+	// notify that lands in between is never lost. notifying with nobody asleep is
+	// just a load
+	//
+	//   auto key = event.prepareWait();
+	//   if (haveWork()) { event.cancelWait(); ... } else { event.commitWait(key); }
+	class EventCount
+	{
+	public:
+		using Key = uint32_t;
+
+		EventCount() = default;
+		EventCount(const EventCount&) = delete;
+		auto operator=(const EventCount&) -> EventCount& = delete;
+
+		auto prepareWait() -> Key
+		{
+			_waiters.fetch_add(1, std::memory_order_seq_cst);
+			return _epoch.load(std::memory_order_seq_cst);
+		}
+
+		void cancelWait()
+		{
+			_waiters.fetch_sub(1, std::memory_order_seq_cst);
+		}
+
+		// sleeps until someone notifies after prepareWait returned key
+		void commitWait(Key key);
+
+		// wakes up to count sleeping threads
+		void notify(uint32_t count = 1);
+		void notifyAll();
+
+		[[nodiscard]] auto waiting() const -> uint32_t
+		{
+			return _waiters.load(std::memory_order_relaxed);
+		}
+
+	private:
+		void _wake(uint32_t count);
+
+		// the futex word, bumped on every notify that found someone waiting
+		alignas(64) std::atomic<uint32_t> _epoch{0};
+		std::atomic<uint32_t> _waiters{0};
+
+#ifndef __linux__
+		std::mutex _mutex;
+		std::condition_variable _condition;
+#endif
+	};
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+#include "core/jobs/JobTypes.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ucontext.h>
+#include <vector>
+
+namespace core::jobs
+{
+	class Job;
+	class JobCounter;
+
+	enum class FiberStatus : char
+	{
+		Running,
+		Finished, // job is done, the fiber can take another one
+		Parked,	  // waiting on a counter, resumed when it hits 0
+		Yielded	  // wants to run again later (waiting on something without a wait list)
+	};
+
+	// a small stack plus a saved context. a fiber runs one job at a time and keeps
+	// looping, so after the first switch there's no setup cost. when the job waits it
+	// switches back to whoever resumed it and the thread is free to run something else.
+	// a parked fiber can be resumed by any thread
+	class Fiber
+	{
+	public:
+		explicit Fiber(size_t stackSize);
+		~Fiber();
+
+		Fiber(const Fiber&) = delete;
+		auto operator=(const Fiber&) -> Fiber& = delete;
+
+		// the fiber running on this thread, nullptr on a plain thread stack. never
+		// inlined, thread locals can't be cached across a switch since we might come
+		// back on a different thread
+		static auto current() -> Fiber*;
+
+		[[nodiscard]] auto isValid() const -> bool
+		{
+			return stack != nullptr;
+		}
+
+	protected:
+		static void entry(unsigned int low, unsigned int high);
+
+		// switches from the calling thread into the fiber, returns once it finishes,
+		// parks or yields
+		void resume();
+
+		// switches from the fiber back to whoever resumed it
+		void suspend(FiberStatus status);
+
+		ucontext_t context;
+		ucontext_t* caller{nullptr};
+		void* stack{nullptr};
+		size_t stackSize;
+
+		Job* job{nullptr};
+		FiberStatus status{FiberStatus::Running};
+		const JobCounter* waitCounter{nullptr};
+
+		inline static thread_local Fiber* currentFiber{nullptr};
+		inline static thread_local ucontext_t threadContext;
+
+		friend class JobManager;
+		friend class FiberPool;
+	};
+
+	class FiberPool
+	{
+	public:
+		static void initialize(size_t count, size_t stackSize);
+		static void shutdown();
+
+		// nullptr once maxCount fibers are out, the job then runs on the thread stack
+		static auto acquire() -> Fiber*;
+		static void release(Fiber* fiber);
+
+	private:
+		inline static std::mutex mutex;
+		inline static std::vector<std::unique_ptr<Fiber>> fibers;
+		inline static std::vector<Fiber*> freeFibers;
+		inline static size_t fiberStackSize{FiberStackSize};
+		inline static size_t maxCount{MaxFibers};
+	};
+}
\ No newline at end of file
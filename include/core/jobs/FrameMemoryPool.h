@@ -4,17 +4,29 @@
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <atomic>
+#include <vector>
 
 namespace core::jobs
 {
+	// every thread carves slabs out of the shared buffer and bump allocates inside its
+	// own slab, so the shared offset is only touched once per slab. if the buffer runs
+	// out, allocations fall back to the heap until the next reset, and the pool grows
+	// so it doesn't happen again
 	class FrameMemoryPool
 	{
 	public:
 		FrameMemoryPool(size_t initialSize = FrameMemorySize); // 4MB default
-		~FrameMemoryPool() = default;
+		~FrameMemoryPool();
+
+		FrameMemoryPool(const FrameMemoryPool&) = delete;
+		auto operator=(const FrameMemoryPool&) -> FrameMemoryPool& = delete;
 
 		auto allocate(size_t size, size_t alignment = alignof(std::max_align_t)) -> void*;
+
+		// nothing can still be pointing into the pool when this runs, JobManager only
+		// calls it once every frame is done with its jobs
 		void reset();
 
 		[[nodiscard]] auto getBytesUsed() const -> size_t;
@@ -30,16 +42,63 @@ namespace core::jobs
 			size_t totalAllocations = 0;
 			size_t totalBytesAllocated = 0;
 			size_t resizesPerformed = 0;
+			size_t overflowAllocations = 0;
 		};
 
-		[[nodiscard]] auto getStats() const -> const Stats&;
+		// adds up what every thread did so far this frame
+		[[nodiscard]] auto getStats() const -> Stats;
+
+		static constexpr size_t SlabSize = (size_t)(64 * 1024);
+
+		// how many pools a thread can hold a slab in at once. every pool keeps a slot of
+		// its own until it's destroyed, past that many live pools they have to share
+		static constexpr size_t SlabSlots = FramesInFlight * 2;
 
 	private:
+		// a thread's counters for one frame. every thread that allocates in a frame gets
+		// its own and is the only one writing to it, so counting is a plain load and
+		// store like the telemetry (except for the shared one, see _join)
+		struct alignas(64) ThreadStats
+		{
+			std::atomic<size_t> allocations{0};
+			std::atomic<size_t> bytes{0};
+		};
+
+		// what a thread is currently bump allocating from. the epoch changes on every
+		// reset (and is unique across pools), so stale slabs are never reused
+		struct Slab
+		{
+			uint64_t epoch{0};
+			uint8_t* cursor{nullptr};
+			uint8_t* end{nullptr};
+			ThreadStats* stats{nullptr};
+		};
+
+		// first allocation of the thread in this frame, picks its stats slot
+		void _join(Slab& slab);
+
+		// lowest free slab slot, or a shared one (and _ownsSlabSlot false) if all are taken
+		auto _takeSlabSlot() -> size_t;
+
+		auto _claim(size_t size, size_t alignment) -> void*;
+		auto _allocateOverflow(size_t size, size_t alignment) -> void*;
 		void _resize(size_t newSize);
 
 		std::unique_ptr<uint8_t[]> _memory;
 		std::atomic<size_t> _offset;
 		size_t _size;
+		uint64_t _epoch;
+		bool _ownsSlabSlot{false}; // before _slabSlot, _takeSlabSlot sets it
+		size_t _slabSlot;
+
+		std::mutex _overflowMutex;
+		std::vector<std::unique_ptr<uint8_t[]>> _overflow;
+		std::atomic<size_t> _overflowBytes{0};
+
+		// handed out in order every frame, threads past the end share the last one
+		static constexpr size_t StatSlots = MaxWorkerThreads + 8;
+		ThreadStats _threadStats[StatSlots + 1];
+		std::atomic<size_t> _statSlotsUsed{0};
 
 		int _overuseCount = 0;
 		int _underuseCount = 0;
@@ -53,8 +112,15 @@ namespace core::jobs
 
 		// Sliding window for peak tracking
 		std::deque<size_t> _recentUsage;
-		const int UsageWindow = 60;
+		const size_t UsageWindow = 60;
 
 		Stats _stats;
+
+		inline static std::atomic<uint64_t> nextEpoch{1};
+		inline static std::atomic<uint32_t> slabSlotsTaken{0}; // bit per slot
+
+		// a worker going back and forth between jobs of different frames keeps its
+		// slab in each of them instead of claiming a new one on every switch
+		static thread_local Slab slabs[SlabSlots];
 	};
-}
\ No newline at end of file
+}
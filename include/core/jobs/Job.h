@@ -1,26 +1,30 @@
 #pragma once
+#include "core/jobs/JobCounter.h"
 #include "core/jobs/JobTypes.h"
 #include <atomic>
-#include <chrono>
+#include <vector>
 
 namespace core::jobs
 {
+	class Fiber;
+
+	// jobs live in the JobPool and get recycled once they finish, so don't hold on to
+	// a Job* outside of its work function, use a JobHandle instead
 	class Job
 	{
 	public:
 		using WorkFunction = void (*)(Job*, void*);
 
-		Job(WorkFunction work, void* data = nullptr, JobPriority priority = JobPriority::Normal)
-			: priority(priority), id(nextJobID.fetch_add(1)), work(work), data(data)
-		{
-		}
+		// gets the job's data instead of the work function if the job never runs
+		using CleanupFunction = void (*)(void*);
+
+		Job() = default;
+		Job(const Job&) = delete;
+		auto operator=(const Job&) -> Job& = delete;
 
 		void execute();
 		void waitForDependencies();
 
-		void wait();
-		auto wait(std::chrono::milliseconds timeout) -> bool;
-
 		[[nodiscard]] auto getState() const -> JobState
 		{
 			return state;
@@ -31,9 +35,25 @@ namespace core::jobs
 			return priority;
 		}
 
+		[[nodiscard]] auto getHandle() const -> JobHandle
+		{
+			return {index, generation.load(std::memory_order_relaxed)};
+		}
+
 		[[nodiscard]] auto getId() const -> JobID
 		{
-			return id;
+			return getHandle().toID();
+		}
+
+		// telemetryNow() time the job should have started by, 0 if it doesn't care
+		[[nodiscard]] auto getDeadline() const -> uint64_t
+		{
+			return deadline;
+		}
+
+		[[nodiscard]] auto getData() const -> void*
+		{
+			return data;
 		}
 
 		void setData(void* data)
@@ -42,17 +62,54 @@ namespace core::jobs
 		}
 
 	protected:
-		std::atomic<JobState> state;
-		JobPriority priority;
-		JobID id;
-		WorkFunction work;
-        void* data;
+		std::atomic<JobState> state{JobState::Created};
+		JobPriority priority{JobPriority::Normal};
+		WorkFunction work{nullptr};
+        void* data{nullptr};
+		CleanupFunction cleanup{nullptr};
 
-		std::atomic<uint32_t> refCount{0}; // dependency number
+		uint32_t index{0};
+		std::atomic<uint32_t> generation{1};
 
-	private:
-		inline static std::atomic<unsigned long> nextJobID{1};
+		// unfinished dependencies, plus one until the job gets submitted. whoever
+		// brings it down to 0 pushes the job to a queue, so it never sits there blocked
+		std::atomic<uint32_t> refCount{1};
+
+		// jobs waiting on this one, guarded by successorLock. slots are reused so the
+		// vector keeps its capacity and stops allocating after warming up
+		std::vector<Job*> successors;
+		std::atomic_flag successorLock = ATOMIC_FLAG_INIT;
+		bool finished{false};
+
+		JobCounter* counter{nullptr};
+		FrameID frame{0};
+
+		// goes through the blocking lane instead of the normal queues
+		bool blocking{false};
 
+		// jobs with a deadline are picked earliest first within their priority
+		uint64_t deadline{0};
+
+		// when the job last became ready, for the latency histograms
+		uint64_t readyTime{0};
+
+		// time spent running before its last slice, a fiber adds its slices up here
+		// every time it parks or yields (only while telemetry is on)
+		uint64_t runTime{0};
+
+		// set while the job runs on a fiber, a parked job keeps its fiber until it
+		// gets resumed and finishes
+		Fiber* fiber{nullptr};
+		Job* nextWaiter{nullptr};
+
+		void lockSuccessors();
+		void unlockSuccessors();
+
+	private:
 		friend class JobManager;
+		friend class JobPool;
+		friend class WorkerThread;
+		friend class JobCounter;
+		friend class Fiber;
 	};
-}
\ No newline at end of file
+}
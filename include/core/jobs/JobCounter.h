@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace core::jobs
+{
+	class Job;
+
+	// counts how many jobs are still in flight, jobs submitted with a counter
+	// decrement it once they finish (failed or not)
+	class JobCounter
+	{
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		auto operator=(const JobCounter&) -> JobCounter& = delete;
+
+		void add(uint32_t count = 1)
+		{
+			_value.fetch_add(count, std::memory_order_relaxed);
+		}
+
+		// wakes up every fiber parked on the counter once it hits 0
+		void decrement();
+
+		[[nodiscard]] auto get() const -> uint32_t
+		{
+			return _value.load(std::memory_order_acquire);
+		}
+
+		[[nodiscard]] auto isDone() const -> bool
+		{
+			// the last decrement still touches the counter after it hits 0, so it
+			// isn't done (and can't be destroyed) until that's over
+			return get() == 0 && !_locked.load(std::memory_order_acquire);
+		}
+
+		// on a fiber the job gets parked until the counter hits 0, anywhere else it
+		// runs other jobs while waiting instead of blocking
+		void wait() const;
+
+	private:
+		void _lock() const;
+		void _unlock() const;
+
+		std::atomic<uint32_t> _value{0};
+
+		// jobs parked on this counter, linked through Job::nextWaiter
+		mutable std::atomic<bool> _locked{false};
+		mutable Job* _waiters{nullptr};
+
+		friend class JobManager;
+	};
+}
\ No newline at end of file
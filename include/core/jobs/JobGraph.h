@@ -0,0 +1,62 @@
+#pragma once
+#include "core/jobs/Job.h"
+#include "core/jobs/JobCounter.h"
+#include <vector>
+
+namespace core::jobs
+{
+	// a set of jobs and the edges between them, declared up front and submitted once.
+	// nodes only become visible to the workers when everything before them finished
+	class JobGraph
+	{
+	public:
+		using NodeID = size_t;
+
+		// what addNode hands back when it couldn't make the node
+		static constexpr NodeID InvalidNode = ~NodeID(0);
+
+		JobGraph() = default;
+
+		// whatever got submitted is waited on (its jobs point at our counter), nodes
+		// that never got submitted give their slots back
+		~JobGraph();
+
+		JobGraph(const JobGraph&) = delete;
+		auto operator=(const JobGraph&) -> JobGraph& = delete;
+
+		auto addNode(Job::WorkFunction work, void* data = nullptr,
+					 JobPriority priority = JobPriority::Normal) -> NodeID;
+
+		// "to" won't start until "from" is done
+		void addEdge(NodeID from, NodeID to);
+
+		// graphs are one-shot, submitting twice does nothing. nodes go out after their
+		// dependencies, so if the job system turns one away (shutting down) nothing that
+		// made it out depends on it. the rest is turned away too and submit returns false
+		auto submit() -> bool;
+
+		void wait() const;
+
+		[[nodiscard]] auto isComplete() const -> bool
+		{
+			return (_submitted || _failed) && _counter.isDone();
+		}
+
+		[[nodiscard]] auto getJob(NodeID node) const -> JobHandle
+		{
+			return node < _nodes.size() ? _nodes[node] : InvalidJobHandle;
+		}
+
+		[[nodiscard]] auto size() const -> size_t
+		{
+			return _nodes.size();
+		}
+
+	private:
+		std::vector<JobHandle> _nodes;
+		std::vector<std::vector<NodeID>> _successors; // by node, from addEdge
+		JobCounter _counter;
+		bool _submitted{false};
+		bool _failed{false};
+	};
+}
\ No newline at end of file
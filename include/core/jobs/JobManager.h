@@ -1,10 +1,19 @@
 #pragma once
 #include "Job.h"
 #include "concurrentqueue.h"
+#include "core/jobs/EventCount.h"
+#include "core/jobs/Fiber.h"
+#include "core/jobs/FrameMemoryPool.h"
+#include "core/jobs/JobPool.h"
+#include "core/jobs/Scheduler.h"
+#include "core/jobs/Telemetry.h"
 #include "core/jobs/WorkerThread.h"
-#include <condition_variable>
+#include <algorithm>
+#include <chrono>
 #include <memory>
-#include <unordered_map>
+#include <mutex>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace core::jobs
@@ -19,40 +28,337 @@ namespace core::jobs
 		std::atomic<size_t> currentQueueSize;
 	};
 
+	// how long an idle worker keeps looking for work before it goes to sleep. spinning
+	// picks up new jobs sooner, sleeping early saves power (and other people's cores)
+	struct ParkingConfig
+	{
+		uint32_t spinIterations{256}; // busy polls, with a cpu pause in between
+		uint32_t yieldIterations{8};  // polls that give the core away in between
+	};
+
+	// jobs held back until a fence signals, see JobManager::submitJobAfter
+	struct FenceWaiter
+	{
+		FenceID fence;
+		Job* job;
+	};
+
+	// jobs still running per priority for one frame
+	struct FrameFence
+	{
+		std::atomic<FrameID> frame{0};
+		std::atomic<uint32_t> pending[PriorityCount]{};
+		std::atomic<uint32_t> submitted{0};
+
+		// waiting on a fence of this slot's frame (or a later one that'll land here).
+		// `waiting` lets completions skip the lock when nobody is
+		std::mutex waitersLock;
+		std::vector<FenceWaiter> waiters;
+		std::atomic<uint32_t> waiting{0};
+
+		[[nodiscard]] auto isDrained() const -> bool
+		{
+			for (const auto& count : pending)
+			{
+				if (count.load(std::memory_order_acquire) != 0)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+	};
+
+	// frame-temp memory for one frame. it stays alive until the frame's jobs are done
+	// and every consumer (render thread, whoever got handed the frame) released it
+	struct FrameArena
+	{
+		FrameMemoryPool pool;
+		std::atomic<FrameID> frame{0};
+		std::atomic<uint32_t> consumers{0};
+	};
+
 	class JobManager
 	{
 	public:
-		static void initialize();
+		// 0 threads means hardware_concurrency - 1 (one is reserved for main). with
+		// fibers on, jobs run on their own small stacks and waiting parks the job
+		// instead of running other jobs on top of it
+		static void initialize(size_t threadCount = 0, bool useFibers = false);
 		static void shutdown();
 
-		static auto submitJob(const std::shared_ptr<Job>& job) -> JobID;
-        static auto getJob(JobID job) -> std::shared_ptr<Job>;
-		static void addDependency(const std::shared_ptr<Job>& dependent, const std::shared_ptr<Job>& dependency);
+		// grabs a slot from the pool, the job doesn't run until it gets submitted
+		static auto createJob(Job::WorkFunction work, void* data = nullptr,
+							  JobPriority priority = JobPriority::Normal) -> JobHandle;
+
+		// the counter (if any) gets incremented now and decremented when the job finishes
+		static auto submitJob(JobHandle job, JobCounter* counter = nullptr) -> JobHandle;
+		static auto submitJob(Job::WorkFunction work, void* data = nullptr,
+							  JobPriority priority = JobPriority::Normal,
+							  JobCounter* counter = nullptr) -> JobHandle;
+
+		// for jobs that sit on a syscall (file reads, sockets...) most of the time. they
+		// run on the workers like everything else but only a few at once (see
+		// setBlockingLaneSize), so they can't take the whole pool hostage
+		static auto submitBlockingJob(Job::WorkFunction work, void* data = nullptr,
+									  JobCounter* counter = nullptr) -> JobHandle;
+
+		// createJob for the blocking lane
+		static auto createBlockingJob(Job::WorkFunction work, void* data = nullptr)
+			-> JobHandle;
+
+		// same as submitJob but takes any callable, which gets moved to the heap. meant
+		// for one-off background work, hot paths should stick to plain functions
+		template <typename Fn>
+		static auto submitTask(Fn&& fn, JobPriority priority = JobPriority::Background,
+							   JobCounter* counter = nullptr) -> JobHandle
+		{
+			using Task = std::decay_t<Fn>;
+			auto* task = new Task(std::forward<Fn>(fn));
+
+			auto handle = createJob(&runTask<Task>, task, priority);
+			setCleanup(handle, &destroyTask<Task>);
 
-        static void beginFrame();
+			handle = submitJob(handle, counter);
+			if (!handle.isValid())
+			{
+				delete task;
+			}
+
+			return handle;
+		}
+
+		template <typename Fn>
+		static auto submitBlockingTask(Fn&& fn, JobCounter* counter = nullptr) -> JobHandle
+		{
+			using Task = std::decay_t<Fn>;
+			auto* task = new Task(std::forward<Fn>(fn));
+
+			auto handle = createBlockingJob(&runTask<Task>, task);
+			setCleanup(handle, &destroyTask<Task>);
+
+			handle = submitJob(handle, counter);
+			if (!handle.isValid())
+			{
+				delete task;
+			}
+
+			return handle;
+		}
+
+		// how many blocking jobs can run at the same time
+		static void setBlockingLaneSize(size_t size)
+		{
+			blockingLaneSize.store((uint32_t)std::max<size_t>(size, 1),
+								   std::memory_order_relaxed);
+		}
+
+		// nullptr once the job is done. the slot gets reused after that, so the pointer
+		// is only good for as long as you know the job can't finish
+		static auto getJob(JobHandle job) -> Job*;
+
+		// has to be called before dependent is submitted
+		static void addDependency(JobHandle dependent, JobHandle dependency);
+
+		// submits the job, but it only becomes ready once `after` hits 0 (right away if
+		// it already is). the counter has to outlive the wait
+		static auto submitJobAfter(JobHandle handle, const JobCounter& after,
+								   JobCounter* counter = nullptr) -> JobHandle;
+
+		// same, but the job waits for a fence. it isn't submitted (or tagged with a
+		// frame) until the fence signals, so it doesn't count towards any frame in the
+		// meantime and waiting on a later frame can't hold up beginFrame
+		static auto submitJobAfter(JobHandle handle, FenceID after,
+								   JobCounter* counter = nullptr) -> JobHandle;
+
+		// has to be called before the job is submitted. jobs that are still queued at
+		// shutdown don't run, they get cancelled: cleanup gets their data (to free it)
+		// and they finish as failed. a job that got turned away by submitJob is just
+		// dropped though, freeing the data is up to whoever submitted it then
+		static void setCleanup(JobHandle job, Job::CleanupFunction cleanup);
+
+		// has to be called before the job is submitted. within its priority the job runs
+		// before anything without a deadline (earliest deadline first), and once the
+		// deadline passes its whole priority jumps ahead of the others
+		static void setDeadline(JobHandle job, std::chrono::steady_clock::time_point deadline);
+
+		// a job is complete once its handle goes stale, whether it succeeded or not
+		static auto isComplete(JobHandle job) -> bool;
+		static void wait(JobHandle job);
+		static auto wait(JobHandle job, std::chrono::milliseconds timeout) -> bool;
+
+		// runs one ready job on the calling thread, returns false if there was nothing
+		// to run. this is how waits help out instead of blocking, from any thread.
+		// does nothing on a fiber, waiting there parks the job instead
+		static auto help() -> bool;
+
+		[[nodiscard]] static auto usingFibers() -> bool
+		{
+			return fibersEnabled;
+		}
+
+		// starts a new frame, every job submitted from outside a job gets tagged with it
+		// (jobs spawned by other jobs inherit their parent's frame). the frame that used
+		// the same slot FramesInFlight frames ago has to be finished (jobs done, arena
+		// released) first, this helps out until it is
+        static auto beginFrame() -> FrameID;
+
+		// drops the main loop's hold on the frame's arena
         static void endFrame();
 
+		[[nodiscard]] static auto getFrame() -> FrameID
+		{
+			return currentFrame.load(std::memory_order_acquire);
+		}
+
+		// the frame of the job running on this thread, or the current one outside jobs.
+		// it's what anything submitted from here gets tagged with
+		[[nodiscard]] static auto getExecutingFrame() -> FrameID;
+
+		// signaled once every job of that priority from the frame (0 = current) is done,
+		// including the ones they spawned. frame fences cover every priority
+		static auto createFence(JobPriority priority, FrameID frame = 0) -> FenceID;
+		static auto createFrameFence(FrameID frame = 0) -> FenceID;
+		static auto isSignaled(FenceID fence) -> bool;
+		static void waitForFence(FenceID fence);
+
+		// the frame's arena, nullptr if the frame is already gone (or didn't start yet)
+		static auto getFrameMemory(FrameID frame = 0) -> FrameMemoryPool*;
+
+		// anything that reads a frame's memory after endFrame (like the renderer picking
+		// up what the tick produced) retains it before that and releases it when done
+		static auto retainFrame(FrameID frame) -> bool;
+		static void releaseFrame(FrameID frame);
+
+		// copies the counters every worker keeps for itself, workers never publish
+		// anything so this costs nothing until somebody calls it
+		static auto getTelemetry() -> TelemetrySnapshot;
+
+		[[nodiscard]] static auto getStatistics() -> const Statistics&
+		{
+			return stats;
+		}
+
+		// timing is on by default, turning it off skips the clock reads around jobs
+		static void setTelemetryEnabled(bool enabled)
+		{
+			telemetryEnabled.store(enabled, std::memory_order_relaxed);
+		}
+
+		static void setParkingConfig(const ParkingConfig& config);
+		static auto getParkingConfig() -> ParkingConfig;
+
+		// aging and time shares, see SchedulerConfig
+		static void setSchedulerConfig(const SchedulerConfig& config)
+		{
+			Scheduler::setConfig(config);
+		}
+
+		static auto getSchedulerConfig() -> SchedulerConfig
+		{
+			return Scheduler::getConfig();
+		}
+
 		static auto threadCount() -> size_t
 		{
 			return workerThreads.size();
 		}
 
 	protected:
-		static auto dequeueJob() -> std::shared_ptr<Job>;
-		static void onComplete(JobID id);
+		static auto dequeueJob() -> Job*;
+		static auto dequeueBlockingJob() -> Job*;
+
+		// one priority's worth of dequeueJob: deadlines, local, shared, then stealing
+		static auto takeFromBand(WorkerThread* worker, size_t priority) -> Job*;
+
+		// a job on a counter's wait list: parked fibers go straight back to the queues,
+		// jobs from submitJobAfter drop the reference the counter was holding
+		static void resumeWaiter(Job* job);
+
+		// submits whatever in the slot is waiting on a fence that signaled by now
+		static void releaseFenceWaiters(FrameFence& fence);
+		static auto hasBlockingWork() -> bool;
+
+		template <typename Task> static void runTask(Job* /*job*/, void* data)
+		{
+			std::unique_ptr<Task> task(static_cast<Task*>(data));
+			(*task)();
+		}
+
+		template <typename Task> static void destroyTask(void* data)
+		{
+			delete static_cast<Task*>(data);
+		}
+
+		// finishes a job that never got to run (see setCleanup)
+		static void cancelJob(Job* job);
 
-		inline static moodycamel::ConcurrentQueue<std::shared_ptr<Job>> jobQueues[5];
+		// gives back a job submitJob turned away, once nothing points at it anymore.
+		// no cleanup, freeing its data is up to whoever tried to submit it
+		static void dropJob(Job* job);
+		static auto stealJob(WorkerThread* thief, size_t priority) -> Job*;
+		static void enqueueJob(Job* job);
+		static void makeReady(Job* job);
+		static void onComplete(Job* job);
+
+		// runs (or resumes) a job, on a fiber if they're enabled. returns true if the
+		// job finished successfully, false if it failed or got parked
+		static auto runJob(Job* job) -> bool;
+		static auto runInline(Job* job) -> bool;
+
+		// fiber only, switches back to the thread until the counter hits 0
+		static void park(const JobCounter* counter);
+
+		// lets something else run for a bit, yielding the fiber if we're on one
+		static void pause();
+
+		// injection queues, used by anything that isn't a worker (main, tick, render...)
+		inline static moodycamel::ConcurrentQueue<Job*> jobQueues[PriorityCount];
 		inline static std::vector<std::unique_ptr<WorkerThread>> workerThreads;
 		inline static Statistics stats;
         inline static std::atomic<bool> shutdownRequested{false};
-		inline static std::mutex mutex;
-		inline static std::condition_variable condition;
+		// blocking jobs wait here and don't count towards activeJobCount, a worker
+		// only takes one if the lane has room
+		inline static moodycamel::ConcurrentQueue<Job*> blockingQueue;
+		inline static std::atomic<uint32_t> blockingRunning{0};
+		inline static std::atomic<uint32_t> blockingLaneSize{2};
+
+		// idle workers sleep here, every job that becomes ready wakes one of them
+		inline static EventCount workAvailable;
+		inline static std::atomic<uint32_t> spinIterations{ParkingConfig{}.spinIterations};
+		inline static std::atomic<uint32_t> yieldIterations{ParkingConfig{}.yieldIterations};
 		inline static std::atomic<JobID> activeJobCount;
 		inline static thread_local WorkerThread* currentWorkerThread;
-		inline static std::unordered_map<JobID, std::vector<std::shared_ptr<Job>>>
-			dependents;
+		inline static thread_local uint32_t stealSeed{0x9E3779B9};
+
+		inline static bool fibersEnabled{false};
+
+		// one slot per frame in flight, indexed by frame % FramesInFlight
+		inline static FrameFence frameFences[FramesInFlight];
+		inline static std::atomic<FrameID> currentFrame{0};
+		inline static std::unique_ptr<FrameArena> frameArenas[FramesInFlight];
+		inline static uint64_t frameStartTime{0};
+		inline static std::atomic<bool> telemetryEnabled{true};
+		inline static bool frameEnded{false};
+
+		// the job this thread is running, so whatever it submits lands on its frame
+		inline static thread_local Job* executingJob{nullptr};
+
+		// what the last runJob on this thread did: whether the job is done (and not just
+		// parked or yielded), and how long it ran before this slice if it is
+		struct RunResult
+		{
+			bool finished;
+			uint64_t earlierRunTime;
+		};
+		inline static thread_local RunResult lastRun;
+
+		// the last finished fiber, kept around so most jobs don't go to the pool
+		inline static thread_local Fiber* spareFiber{nullptr};
 
 		friend class WorkerThread;
         friend class Job;
+		friend class JobCounter;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include "core/jobs/Job.h"
+#include "core/jobs/JobTypes.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace core::jobs
+{
+	// recycles Job slots so submitting and finishing a job doesn't touch the heap.
+	// every thread keeps a small cache of free slots and only goes to the shared list
+	// (in batches) when it runs dry or overflows. slots are allocated in chunks that
+	// never move or get freed, so a Job* stays valid (if stale) forever
+	class JobPool
+	{
+	public:
+		static constexpr uint32_t ChunkSize = 1024;
+		static constexpr uint32_t MaxChunks = 1024;
+		static constexpr uint32_t CacheSize = 128;
+		static constexpr uint32_t TransferBatch = CacheSize / 2;
+
+		static void reserve(size_t jobCount);
+
+		static auto allocate() -> Job*;
+		static void release(Job* job);
+
+		// nullptr if the handle is stale (the job finished and its slot was reused)
+		static auto get(JobHandle handle) -> Job*;
+
+		[[nodiscard]] static auto capacity() -> size_t
+		{
+			return (size_t)chunkCount.load(std::memory_order_acquire) * ChunkSize;
+		}
+
+	private:
+		struct LocalCache
+		{
+			uint32_t indices[CacheSize];
+			uint32_t count{0};
+
+			~LocalCache();
+		};
+
+		static auto _slot(uint32_t index) -> Job*
+		{
+			return &chunks[index / ChunkSize].load(std::memory_order_acquire)[index % ChunkSize];
+		}
+
+		static void _grow();
+		static auto _refill(LocalCache& cache) -> bool;
+		static void _flush(LocalCache& cache, uint32_t count);
+
+		inline static std::atomic<Job*> chunks[MaxChunks];
+		inline static std::atomic<uint32_t> chunkCount{0};
+
+		// shared free list, only touched in batches
+		inline static std::mutex mutex;
+		inline static std::vector<uint32_t> freeList;
+
+		static thread_local LocalCache cache;
+	};
+}
\ No newline at end of file
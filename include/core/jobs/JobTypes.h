@@ -12,9 +12,44 @@ namespace core::jobs
 	constexpr JobID InvalidJobID = 0;
 	constexpr FenceID InvalidFenceID = 0;
 	constexpr size_t MaxWorkerThreads = 64;
+	constexpr size_t PriorityCount = 5;
 	constexpr size_t MaxJobsPerFrame = 2048;
+	constexpr size_t FramesInFlight = 3;
 	constexpr size_t FrameMemorySize = (size_t)(4 * 1024 * 1024);
 	constexpr size_t MinFrameMemorySize = (size_t)(512 * 1024);
+	constexpr size_t FiberStackSize = (size_t)(64 * 1024);
+	constexpr size_t FiberCount = 128;
+	constexpr size_t MaxFibers = 1024;
+
+	// index into the job pool plus the generation of the slot, once a job finishes
+	// its slot gets recycled and old handles simply stop resolving
+	struct JobHandle
+	{
+		uint32_t index{0};
+		uint32_t generation{0}; // 0 is never handed out
+
+		[[nodiscard]] auto isValid() const -> bool
+		{
+			return generation != 0;
+		}
+
+		[[nodiscard]] auto toID() const -> JobID
+		{
+			return ((JobID)generation << 32) | index;
+		}
+
+		auto operator==(const JobHandle& other) const -> bool
+		{
+			return index == other.index && generation == other.generation;
+		}
+
+		auto operator!=(const JobHandle& other) const -> bool
+		{
+			return !(*this == other);
+		}
+	};
+
+	constexpr JobHandle InvalidJobHandle{};
 
 	enum class JobPriority : char
 	{
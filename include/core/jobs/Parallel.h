@@ -0,0 +1,123 @@
+#pragma once
+#include "core/jobs/JobTypes.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace core::jobs
+{
+	namespace internals
+	{
+		// the range gets cut into grain-sized chunks and everybody taking part (helper
+		// jobs on the workers plus the calling thread) keeps claiming the next one until
+		// they run out, so a slow chunk doesn't leave the rest of the threads idle
+		struct ParallelRange
+		{
+			size_t begin;
+			size_t end;
+			size_t grain;
+			size_t chunkCount;
+			std::atomic<size_t> next{0};
+
+			void* body;
+			void (*run)(void* body, size_t chunk, size_t begin, size_t end);
+
+			// the first exception a helper ran into, rethrown on the caller once
+			// everybody is done
+			std::atomic<bool> failed{false};
+			std::exception_ptr error;
+		};
+
+		// 0 picks a grain that leaves a few chunks per thread
+		auto resolveGrain(size_t count, size_t grain) -> size_t;
+
+		// runs every chunk and returns once all of them are done. the caller works
+		// through chunks too and then helps with other jobs until the helpers finish.
+		// if a chunk throws, the chunks nobody claimed yet are skipped and the
+		// exception comes out of here
+		void parallelDispatch(ParallelRange& range, JobPriority priority);
+	}
+
+	// fn is either fn(size_t index) or fn(size_t begin, size_t end) for a whole chunk,
+	// the second one is better when the per-index work is tiny
+	template <typename Fn>
+	void parallelFor(size_t begin, size_t end, size_t grain, Fn&& fn,
+					 JobPriority priority = JobPriority::Normal)
+	{
+		if (end <= begin)
+		{
+			return;
+		}
+
+		internals::ParallelRange range;
+		range.begin = begin;
+		range.end = end;
+		range.grain = internals::resolveGrain(end - begin, grain);
+		range.chunkCount = (end - begin + range.grain - 1) / range.grain;
+		range.body = (void*)&fn;
+		range.run = [](void* body, size_t /*chunk*/, size_t first, size_t last)
+		{
+			auto& function = *static_cast<std::remove_reference_t<Fn>*>(body);
+			if constexpr (std::is_invocable_v<Fn&, size_t, size_t>)
+			{
+				function(first, last);
+			}
+			else
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					function(i);
+				}
+			}
+		};
+
+		internals::parallelDispatch(range, priority);
+	}
+
+	// map(begin, end) -> T reduces one chunk, reduce(T, T) -> T merges two results.
+	// chunks are merged in order, so the result is the same every run as long as
+	// the grain stays the same
+	template <typename T, typename Map, typename Reduce>
+	auto parallelReduce(size_t begin, size_t end, size_t grain, T identity, Map&& map,
+						Reduce&& reduce, JobPriority priority = JobPriority::Normal) -> T
+	{
+		if (end <= begin)
+		{
+			return identity;
+		}
+
+		struct Body
+		{
+			std::remove_reference_t<Map>* map;
+			std::vector<T> partials;
+		};
+
+		internals::ParallelRange range;
+		range.begin = begin;
+		range.end = end;
+		range.grain = internals::resolveGrain(end - begin, grain);
+		range.chunkCount = (end - begin + range.grain - 1) / range.grain;
+
+		Body body{&map, std::vector<T>(range.chunkCount, identity)};
+		range.body = &body;
+		range.run = [](void* data, size_t chunk, size_t first, size_t last)
+		{
+			auto* body = static_cast<Body*>(data);
+			body->partials[chunk] = (*body->map)(first, last);
+		};
+
+		internals::parallelDispatch(range, priority);
+
+		T result = std::move(identity);
+		for (auto& partial : body.partials)
+		{
+			result = reduce(std::move(result), std::move(partial));
+		}
+
+		return result;
+	}
+}
\ No newline at end of file
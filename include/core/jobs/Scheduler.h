@@ -0,0 +1,99 @@
+#pragma once
+#include "core/jobs/JobTypes.h"
+#include "core/jobs/Telemetry.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace core::jobs
+{
+	class Job;
+
+	// what dequeueJob does on top of plain "highest priority first"
+	struct SchedulerConfig
+	{
+		// a band that has had ready work sitting around for this long without anyone
+		// picking from it goes first, once. 0 turns aging off for that band (critical
+		// never needs it, nothing's above it)
+		std::chrono::microseconds agingThreshold[PriorityCount]{
+			std::chrono::microseconds(0),	  std::chrono::microseconds(2000),
+			std::chrono::microseconds(4000),  std::chrono::microseconds(8000),
+			std::chrono::microseconds(16000),
+		};
+
+		// the most of a frame's worker time a band gets while other bands have work
+		// waiting. it's only a cap under contention, with nothing else to run a band
+		// over its share still gets the workers. 1 means no cap
+		float timeShare[PriorityCount]{1.0F, 1.0F, 1.0F, 1.0F, 1.0F};
+	};
+
+	// what the scheduler keeps for one priority
+	struct alignas(64) SchedulerBand
+	{
+		std::atomic<uint32_t> ready{0};
+		std::atomic<uint64_t> lastServed{0};
+		std::atomic<uint64_t> frameTime{0};
+		std::atomic<uint64_t> aged{0};
+		std::atomic<uint64_t> deadlineMisses{0};
+
+		// min-heap on Job::deadline, earliest is 0 while it's empty
+		std::mutex deadlineLock;
+		std::vector<Job*> deadlineJobs;
+		std::atomic<uint64_t> earliest{0};
+	};
+
+	// bookkeeping behind dequeueJob's choices: how much work every band has waiting,
+	// when it was last served, how much of the frame it used, and the earliest
+	// deadline first queues for jobs that have a deadline
+	class Scheduler
+	{
+	protected:
+		static constexpr size_t NoBand = PriorityCount;
+
+		static void setConfig(const SchedulerConfig& config);
+		static auto getConfig() -> SchedulerConfig;
+
+		// a job of that band was made ready / taken off a queue
+		static void onReady(size_t band);
+		static void onTaken(size_t band);
+
+		// the band that has to go first right now: starved past its aging threshold or
+		// holding a job that's already past its deadline. NoBand if there's none
+		static auto urgentBand() -> size_t;
+
+		// bit per band that used up its share of the frame so far, 0 if no caps are set
+		static auto overBudgetBands() -> uint32_t;
+
+		static void pushDeadlineJob(Job* job);
+		static auto popDeadlineJob(size_t band) -> Job*;
+
+		// called by workers once a job ran (well, ran a slice of it on fibers)
+		static void recordExecution(size_t band, uint64_t elapsed, uint64_t started,
+									uint64_t deadline);
+
+		static auto hasShares() -> bool
+		{
+			return sharesEnabled.load(std::memory_order_relaxed);
+		}
+
+		static void beginFrame();
+		static auto drain() -> std::vector<Job*>;
+		static void fillSnapshot(BandSnapshot (&bands)[PriorityCount]);
+
+		inline static SchedulerBand bands[PriorityCount];
+		inline static std::atomic<uint64_t> agingThreshold[PriorityCount]{
+			0, 2000000, 4000000, 8000000, 16000000};
+		inline static std::atomic<float> timeShare[PriorityCount]{1.0F, 1.0F, 1.0F, 1.0F,
+																	1.0F};
+		inline static std::atomic<bool> sharesEnabled{false};
+
+		// caps don't mean much before a frame has done some work, this much has to
+		// have run before they kick in
+		static constexpr uint64_t MinShareTime = 500000;
+
+		friend class JobManager;
+		friend class WorkerThread;
+	};
+}
@@ -0,0 +1,431 @@
+#pragma once
+#include "core/jobs/JobManager.h"
+#include "core/log.h"
+
+// coroutines need c++20, build with -Dcoroutines=true (see meson_options.txt)
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#	define ES_COROUTINES 1
+#	include <coroutine>
+#	include <exception>
+#	include <optional>
+#	include <utility>
+
+namespace core::jobs
+{
+	template <typename T, bool FrameLocal> class BasicTask;
+
+	namespace internals
+	{
+		inline void resumeCoroutine(Job* /*job*/, void* data)
+		{
+			std::coroutine_handle<>::from_address(data).resume();
+		}
+
+		// resumes `handle` on a worker, whenever `after` is done (if given)
+		inline void scheduleResume(std::coroutine_handle<> handle, JobPriority priority,
+								   const JobCounter* after = nullptr)
+		{
+			auto job = JobManager::createJob(&resumeCoroutine, handle.address(), priority);
+			if (after != nullptr)
+			{
+				JobManager::submitJobAfter(job, *after);
+				return;
+			}
+
+			JobManager::submitJob(job);
+		}
+
+		// frame-local coroutine frames live in the arena of the frame they were created
+		// in, which stays retained until they're destroyed. the header remembers which
+		// frame that was (0 when it had to go to the heap instead)
+		struct alignas(std::max_align_t) FrameHeader
+		{
+			FrameID frame;
+		};
+
+		inline auto allocateFrameLocal(size_t size) -> void*
+		{
+			FrameID frame = JobManager::getExecutingFrame();
+			auto* pool = JobManager::getFrameMemory(frame);
+
+			FrameHeader* header = nullptr;
+			if (pool != nullptr && JobManager::retainFrame(frame))
+			{
+				header = static_cast<FrameHeader*>(pool->allocate(sizeof(FrameHeader) + size));
+				header->frame = frame;
+			}
+			else
+			{
+				// the frame is already on its way out, can't hang on to its memory
+				header = static_cast<FrameHeader*>(::operator new(sizeof(FrameHeader) + size));
+				header->frame = 0;
+			}
+
+			return header + 1;
+		}
+
+		inline void freeFrameLocal(void* pointer)
+		{
+			auto* header = static_cast<FrameHeader*>(pointer) - 1;
+			if (header->frame == 0)
+			{
+				::operator delete(header);
+				return;
+			}
+
+			// the arena gets it back on reset, all we have to do is let go of the frame
+			JobManager::releaseFrame(header->frame);
+		}
+
+		class TaskPromiseBase
+		{
+		public:
+			auto initial_suspend() noexcept -> std::suspend_always
+			{
+				return {};
+			}
+
+			struct FinalAwaiter
+			{
+				auto await_ready() noexcept -> bool
+				{
+					return false;
+				}
+
+				template <typename Promise>
+				auto await_suspend(std::coroutine_handle<Promise> handle) noexcept
+					-> std::coroutine_handle<>
+				{
+					auto& promise = handle.promise();
+
+					// whoever waits on `done` may destroy the frame right after the
+					// decrement, so everything we need is read before that
+					auto continuation = promise.continuation;
+					bool detached = promise.detached;
+					auto* done = promise.done;
+
+					if (detached)
+					{
+						handle.destroy();
+					}
+					else if (done != nullptr)
+					{
+						done->decrement();
+					}
+
+					return continuation ? continuation : std::noop_coroutine();
+				}
+
+				void await_resume() noexcept {}
+			};
+
+			auto final_suspend() noexcept -> FinalAwaiter
+			{
+				return {};
+			}
+
+			void unhandled_exception()
+			{
+				exception = std::current_exception();
+				if (detached)
+				{
+					log_error("unhandled exception in a detached task");
+				}
+			}
+
+			std::coroutine_handle<> continuation;
+			std::exception_ptr exception;
+			JobCounter* done{nullptr};
+			bool detached{false};
+		};
+
+		template <bool FrameLocal> class TaskAllocator
+		{
+		};
+
+		template <> class TaskAllocator<true>
+		{
+		public:
+			static auto operator new(size_t size) -> void*
+			{
+				return allocateFrameLocal(size);
+			}
+
+			static void operator delete(void* pointer)
+			{
+				freeFrameLocal(pointer);
+			}
+		};
+
+		template <typename T, bool FrameLocal>
+		class TaskPromise : public TaskPromiseBase, public TaskAllocator<FrameLocal>
+		{
+		public:
+			auto get_return_object() -> BasicTask<T, FrameLocal>;
+
+			template <typename U> void return_value(U&& value)
+			{
+				result.emplace(std::forward<U>(value));
+			}
+
+			auto take() -> T
+			{
+				if (exception)
+				{
+					std::rethrow_exception(exception);
+				}
+
+				return std::move(*result);
+			}
+
+			std::optional<T> result;
+		};
+
+		template <bool FrameLocal>
+		class TaskPromise<void, FrameLocal> : public TaskPromiseBase,
+											  public TaskAllocator<FrameLocal>
+		{
+		public:
+			auto get_return_object() -> BasicTask<void, FrameLocal>;
+
+			void return_void() {}
+
+			void take()
+			{
+				if (exception)
+				{
+					std::rethrow_exception(exception);
+				}
+			}
+		};
+	}
+
+	// a coroutine that runs on the job system. it doesn't start until it's awaited
+	// (then it runs right there, on whatever thread awaited it), started (then it goes
+	// to a worker and owns itself) or waited on with get()
+	template <typename T, bool FrameLocal> class [[nodiscard]] BasicTask
+	{
+	public:
+		using promise_type = internals::TaskPromise<T, FrameLocal>;
+		using Handle = std::coroutine_handle<promise_type>;
+
+		BasicTask() = default;
+		explicit BasicTask(Handle handle) : _handle(handle) {}
+
+		BasicTask(const BasicTask&) = delete;
+		auto operator=(const BasicTask&) -> BasicTask& = delete;
+
+		BasicTask(BasicTask&& other) noexcept : _handle(std::exchange(other._handle, {}))
+		{
+		}
+
+		auto operator=(BasicTask&& other) noexcept -> BasicTask&
+		{
+			if (this != &other)
+			{
+				_destroy();
+				_handle = std::exchange(other._handle, {});
+			}
+			return *this;
+		}
+
+		~BasicTask()
+		{
+			_destroy();
+		}
+
+		// fire and forget. it runs on a worker and cleans up after itself
+		void start(JobPriority priority = JobPriority::Normal)
+		{
+			auto handle = std::exchange(_handle, {});
+			handle.promise().detached = true;
+			internals::scheduleResume(handle, priority);
+		}
+
+		// runs it on a worker and waits for the result, helping out in the meantime
+		auto get(JobPriority priority = JobPriority::Normal) -> T
+		{
+			JobCounter done;
+			done.add();
+			_handle.promise().done = &done;
+
+			internals::scheduleResume(_handle, priority);
+			done.wait();
+
+			return _handle.promise().take();
+		}
+
+		struct Awaiter
+		{
+			Handle handle;
+
+			auto await_ready() noexcept -> bool
+			{
+				return false;
+			}
+
+			// symmetric transfer, the awaiting coroutine gets resumed from the task's
+			// final suspend point
+			auto await_suspend(std::coroutine_handle<> awaiting) noexcept
+				-> std::coroutine_handle<>
+			{
+				handle.promise().continuation = awaiting;
+				return handle;
+			}
+
+			auto await_resume() -> T
+			{
+				return handle.promise().take();
+			}
+		};
+
+		auto operator co_await() && noexcept -> Awaiter
+		{
+			return {_handle};
+		}
+
+		auto operator co_await() & noexcept -> Awaiter
+		{
+			return {_handle};
+		}
+
+	private:
+		void _destroy()
+		{
+			if (_handle)
+			{
+				_handle.destroy();
+				_handle = {};
+			}
+		}
+
+		Handle _handle;
+	};
+
+	template <typename T = void> using Task = BasicTask<T, false>;
+
+	// same thing, but the coroutine frame comes out of the current frame's arena. the
+	// frame can't be recycled until the task is destroyed, so keep these short
+	template <typename T = void> using FrameTask = BasicTask<T, true>;
+
+	template <typename T, bool FrameLocal>
+	auto internals::TaskPromise<T, FrameLocal>::get_return_object() -> BasicTask<T, FrameLocal>
+	{
+		return BasicTask<T, FrameLocal>(
+			std::coroutine_handle<TaskPromise<T, FrameLocal>>::from_promise(*this));
+	}
+
+	template <bool FrameLocal>
+	auto internals::TaskPromise<void, FrameLocal>::get_return_object()
+		-> BasicTask<void, FrameLocal>
+	{
+		return BasicTask<void, FrameLocal>(
+			std::coroutine_handle<TaskPromise<void, FrameLocal>>::from_promise(*this));
+	}
+
+	// `co_await schedule()` moves the rest of the coroutine onto a worker
+	struct ScheduleAwaiter
+	{
+		JobPriority priority;
+
+		auto await_ready() noexcept -> bool
+		{
+			return false;
+		}
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			internals::scheduleResume(handle, priority);
+		}
+
+		void await_resume() noexcept {}
+	};
+
+	inline auto schedule(JobPriority priority = JobPriority::Normal) -> ScheduleAwaiter
+	{
+		return {priority};
+	}
+
+	// resumes on a worker once the job is done. the job must not have been waited on
+	// (or be started) by anyone who'd add dependencies to it concurrently
+	struct JobAwaiter
+	{
+		JobHandle job;
+		JobPriority priority;
+
+		auto await_ready() noexcept -> bool
+		{
+			return JobManager::isComplete(job);
+		}
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			auto resume =
+				JobManager::createJob(&internals::resumeCoroutine, handle.address(), priority);
+			JobManager::addDependency(resume, job);
+
+			// nothing can touch the awaiter after this, the coroutine may already be
+			// running again on another thread
+			JobManager::submitJob(resume);
+		}
+
+		void await_resume() noexcept {}
+	};
+
+	inline auto operator co_await(JobHandle job) -> JobAwaiter
+	{
+		return {job, JobPriority::Normal};
+	}
+
+	struct CounterAwaiter
+	{
+		const JobCounter& counter;
+		JobPriority priority;
+
+		auto await_ready() noexcept -> bool
+		{
+			return counter.isDone();
+		}
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			internals::scheduleResume(handle, priority, &counter);
+		}
+
+		void await_resume() noexcept {}
+	};
+
+	inline auto operator co_await(const JobCounter& counter) -> CounterAwaiter
+	{
+		return {counter, JobPriority::Normal};
+	}
+
+	// the resume only gets submitted once the fence signals (see submitJobAfter), so
+	// nothing runs while it waits and the wait doesn't count towards any frame
+	struct FenceAwaiter
+	{
+		FenceID fence;
+		JobPriority priority;
+
+		auto await_ready() noexcept -> bool
+		{
+			return JobManager::isSignaled(fence);
+		}
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			auto job =
+				JobManager::createJob(&internals::resumeCoroutine, handle.address(), priority);
+			JobManager::submitJobAfter(job, fence);
+		}
+
+		void await_resume() noexcept {}
+	};
+
+	inline auto fence(FenceID fence, JobPriority priority = JobPriority::Normal)
+		-> FenceAwaiter
+	{
+		return {fence, priority};
+	}
+}
+#endif
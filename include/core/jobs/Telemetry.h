@@ -0,0 +1,157 @@
+#pragma once
+#include "core/jobs/JobTypes.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace core::jobs
+{
+	inline auto telemetryNow() -> uint64_t
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				   std::chrono::steady_clock::now().time_since_epoch())
+			.count();
+	}
+
+	// power of two buckets over nanoseconds, bucket i holds values below 2^i ns (the
+	// last one takes everything from ~2s up)
+	struct HistogramSnapshot
+	{
+		static constexpr size_t BucketCount = 32;
+
+		uint64_t buckets[BucketCount]{};
+
+		static constexpr auto bucketUpperBound(size_t bucket) -> uint64_t
+		{
+			return (uint64_t)1 << bucket;
+		}
+
+		[[nodiscard]] auto count() const -> uint64_t
+		{
+			uint64_t total = 0;
+			for (auto bucket : buckets)
+			{
+				total += bucket;
+			}
+			return total;
+		}
+
+		// upper bound (in ns) of the bucket the percentile falls in, p goes from 0 to 1
+		[[nodiscard]] auto percentile(double p) const -> uint64_t
+		{
+			uint64_t target = (uint64_t)((double)count() * p);
+			uint64_t seen = 0;
+			for (size_t i = 0; i < BucketCount; i++)
+			{
+				seen += buckets[i];
+				if (seen > target)
+				{
+					return bucketUpperBound(i);
+				}
+			}
+			return bucketUpperBound(BucketCount - 1);
+		}
+	};
+
+	// only ever written by the thread that owns it, so recording is a plain load and
+	// store (no lock prefix). readers may see a value a couple of samples behind
+	struct Histogram
+	{
+		std::atomic<uint64_t> buckets[HistogramSnapshot::BucketCount]{};
+
+		void record(uint64_t nanoseconds)
+		{
+			size_t bucket = nanoseconds == 0 ? 0 : 64 - __builtin_clzll(nanoseconds);
+			if (bucket >= HistogramSnapshot::BucketCount)
+			{
+				bucket = HistogramSnapshot::BucketCount - 1;
+			}
+
+			auto& slot = buckets[bucket];
+			slot.store(slot.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] auto snapshot() const -> HistogramSnapshot
+		{
+			HistogramSnapshot result;
+			for (size_t i = 0; i < HistogramSnapshot::BucketCount; i++)
+			{
+				result.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+			}
+			return result;
+		}
+	};
+
+	// per band counters, waits are ready to started (the same thing the latency
+	// histograms measure) and only recorded while telemetry is on
+	struct BandSnapshot
+	{
+		uint64_t jobs{0};
+		uint64_t waitTime{0}; // ns, total
+		uint64_t maxWait{0};  // ns
+		uint64_t aged{0};	  // picks that skipped ahead because the band was starved
+		uint64_t deadlineMisses{0};
+		uint64_t frameTime{0}; // ns the workers spent on it this frame
+		uint64_t ready{0};	   // waiting to run right now
+
+		[[nodiscard]] auto averageWait() const -> uint64_t
+		{
+			return jobs != 0 ? waitTime / jobs : 0;
+		}
+	};
+
+	// per worker counters, same single writer rule as Histogram
+	struct alignas(64) WorkerTelemetry
+	{
+		Histogram latency;	 // ready to started (submitted to started if no dependencies)
+		Histogram execution; // time spent running a job (every slice of it on fibers)
+
+		std::atomic<uint64_t> jobsExecuted{0};
+		std::atomic<uint64_t> executionTime{0}; // ns
+		std::atomic<uint64_t> steals{0};
+		std::atomic<uint64_t> idleTime{0}; // ns spent spinning or parked
+		std::atomic<uint64_t> parks{0};
+
+		// ready to started, per priority
+		std::atomic<uint64_t> bandJobs[PriorityCount]{};
+		std::atomic<uint64_t> bandWait[PriorityCount]{};
+		std::atomic<uint64_t> bandMaxWait[PriorityCount]{};
+
+		static void add(std::atomic<uint64_t>& counter, uint64_t value)
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + value,
+						  std::memory_order_relaxed);
+		}
+	};
+
+	struct WorkerSnapshot
+	{
+		ThreadID id{0};
+		HistogramSnapshot latency;
+		HistogramSnapshot execution;
+
+		uint64_t jobsExecuted{0};
+		uint64_t executionTime{0};
+		uint64_t steals{0};
+		uint64_t idleTime{0};
+		uint64_t parks{0};
+
+		BandSnapshot bands[PriorityCount]; // only the wait counters are filled in
+	};
+
+	struct TelemetrySnapshot
+	{
+		std::vector<WorkerSnapshot> workers;
+
+		uint64_t totalJobsSubmitted{0};
+		uint64_t totalJobsExecuted{0};
+		uint64_t queueSize{0};
+		uint64_t averageJobsPerFrame{0};
+		FrameID frame{0};
+
+		// every worker's waits added up, plus what the scheduler keeps per band
+		BandSnapshot bands[PriorityCount];
+	};
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace core::jobs
+{
+	// Chase-Lev work stealing deque (as described by Lê et al., "Correct and Efficient
+	// Work-Stealing for Weak Memory Models"). the owner pushes and pops from the bottom,
+	// every other thread steals from the top. it only stores pointers, ownership of the
+	// pointed objects is up to whoever uses it
+	template <typename T> class WorkStealingDeque
+	{
+	public:
+		explicit WorkStealingDeque(size_t initialCapacity = 256)
+		{
+			auto buffer = std::make_unique<Buffer>(initialCapacity);
+			_buffer.store(buffer.get(), std::memory_order_relaxed);
+			_buffers.push_back(std::move(buffer));
+		}
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		auto operator=(const WorkStealingDeque&) -> WorkStealingDeque& = delete;
+
+		// owner only
+		void push(T* item)
+		{
+			int64_t bottom = _bottom.load(std::memory_order_relaxed);
+			int64_t top = _top.load(std::memory_order_acquire);
+			Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+
+			if (bottom - top > buffer->capacity - 1)
+			{
+				buffer = _grow(buffer, top, bottom);
+			}
+
+			buffer->put(bottom, item);
+			std::atomic_thread_fence(std::memory_order_release);
+			_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		// owner only, LIFO so the owner keeps working on whatever is hot in cache
+		auto pop() -> T*
+		{
+			int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+			Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+			_bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t top = _top.load(std::memory_order_relaxed);
+
+			if (top > bottom)
+			{
+				// empty
+				_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			T* item = buffer->get(bottom);
+
+			if (top == bottom)
+			{
+				// last item, race against thieves for it
+				if (!_top.compare_exchange_strong(top, top + 1,
+												  std::memory_order_seq_cst,
+												  std::memory_order_relaxed))
+				{
+					item = nullptr;
+				}
+				_bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+
+			return item;
+		}
+
+		// any thread, FIFO
+		auto steal() -> T*
+		{
+			int64_t top = _top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+			if (top >= bottom)
+			{
+				return nullptr;
+			}
+
+			Buffer* buffer = _buffer.load(std::memory_order_acquire);
+			T* item = buffer->get(top);
+
+			if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+											  std::memory_order_relaxed))
+			{
+				// somebody else got it first
+				return nullptr;
+			}
+
+			return item;
+		}
+
+		[[nodiscard]] auto sizeApprox() const -> size_t
+		{
+			int64_t bottom = _bottom.load(std::memory_order_relaxed);
+			int64_t top = _top.load(std::memory_order_relaxed);
+			return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+		}
+
+		[[nodiscard]] auto empty() const -> bool
+		{
+			return sizeApprox() == 0;
+		}
+
+	private:
+		struct Buffer
+		{
+			int64_t capacity;
+			int64_t mask;
+			std::unique_ptr<std::atomic<T*>[]> data;
+
+			explicit Buffer(size_t size)
+			{
+				// capacity has to be a power of two for the mask to work
+				size_t rounded = 1;
+				while (rounded < size)
+				{
+					rounded <<= 1;
+				}
+
+				capacity = static_cast<int64_t>(rounded);
+				mask = capacity - 1;
+				data = std::make_unique<std::atomic<T*>[]>(rounded);
+			}
+
+			// release/acquire on the slots on top of the fences, so whatever was written
+			// to an item before pushing it is visible to the thief (and to tsan, which
+			// doesn't understand standalone fences)
+			void put(int64_t index, T* item)
+			{
+				data[index & mask].store(item, std::memory_order_release);
+			}
+
+			auto get(int64_t index) const -> T*
+			{
+				return data[index & mask].load(std::memory_order_acquire);
+			}
+		};
+
+		auto _grow(Buffer* old, int64_t top, int64_t bottom) -> Buffer*
+		{
+			auto buffer = std::make_unique<Buffer>(static_cast<size_t>(old->capacity) * 2);
+			for (int64_t i = top; i < bottom; i++)
+			{
+				buffer->put(i, old->get(i));
+			}
+
+			// thieves might still be reading from the old buffer, so it stays alive
+			// until the deque dies. it only ever doubles, so this is bounded
+			Buffer* result = buffer.get();
+			_buffers.push_back(std::move(buffer));
+			_buffer.store(result, std::memory_order_release);
+			return result;
+		}
+
+		alignas(64) std::atomic<int64_t> _top{0};
+		alignas(64) std::atomic<int64_t> _bottom{0};
+		alignas(64) std::atomic<Buffer*> _buffer{nullptr};
+		std::vector<std::unique_ptr<Buffer>> _buffers;
+	};
+}
\ No newline at end of file
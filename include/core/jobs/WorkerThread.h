@@ -1,8 +1,9 @@
 #pragma once
 #include "core/jobs/Job.h"
 #include "core/jobs/JobTypes.h"
+#include "core/jobs/Telemetry.h"
+#include "core/jobs/WorkStealingDeque.h"
 #include <memory>
-#include <mutex>
 #include <thread>
 #include <atomic>
 
@@ -23,20 +24,34 @@ namespace core::jobs
 		}
 
 		auto executeNextJob() -> bool;
-		void executeJob(const std::shared_ptr<Job>& job);
+		// runs the job and gives its slot back, true if it finished successfully
+		auto executeJob(Job* job) -> bool;
 
 		void yield();
 
+		[[nodiscard]] auto getId() const -> ThreadID
+		{
+			return id;
+		}
+
+		[[nodiscard]] auto getTelemetry() const -> WorkerSnapshot;
+
 	protected:
         void workerThreadMain();
 
+		// sleeps until a job becomes ready (or we're shutting down)
+		void park();
+
+		// one deque per priority, jobs submitted from this worker land here and
+		// other workers steal from the top when they run out of work
+		WorkStealingDeque<Job> deques[PriorityCount];
+
         ThreadID id;
         std::unique_ptr<std::thread> thread;
 		std::atomic<bool> shouldStop{false};
-        std::mutex mutex;
 
-		std::atomic<uint64_t> jobsExecuted{0};
-		std::atomic<std::chrono::microseconds> totalExecutionTime{
-			std::chrono::microseconds::zero()};
+		WorkerTelemetry telemetry;
+
+		friend class JobManager;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+#include "utils/math/Matrix4.h"
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace core
+{
+	class Scene;
+	class Entity;
+}
+
+namespace graphics
+{
+	struct CameraView
+	{
+		uint32_t entity{0};
+		int renderOrder{0};
+		math::Matrix4 view;
+		math::Matrix4 projection;
+	};
+
+	// everything the render thread gets to see of the scene, copied out at the end of
+	// a tick. kept as flat arrays (index i is the same entity in all of them)
+	struct RenderSnapshot
+	{
+		uint64_t tick{0};
+
+		std::vector<uint32_t> entities;
+		std::vector<math::Matrix4> world;
+		std::vector<math::Matrix4> previousWorld; // one tick before world, for blending
+		std::vector<uint8_t> visible;
+
+		std::vector<CameraView> cameras; // sorted by render order
+
+		void clear()
+		{
+			entities.clear();
+			world.clear();
+			previousWorld.clear();
+			visible.clear();
+			cameras.clear();
+		}
+	};
+
+	// tick -> render handoff. there's a buffer being written, one being read and a
+	// spare in between, and publishing/acquiring just swap indices with the spare, so
+	// neither side ever waits on the other or sees a half written snapshot. the
+	// vectors keep their capacity, after a few ticks extraction stops allocating
+	class RenderSnapshots
+	{
+	public:
+		// tick thread. copies the scene out and publishes it
+		static void extract(core::Scene* scene, uint64_t tick);
+
+		// tick thread, right before the last tick of an update that runs several. the
+		// alpha only ever spans one step, so that's what the next extract blends from
+		// instead of a snapshot that's a few ticks old by then
+		static void capturePrevious(core::Scene* scene);
+
+		// render thread. the newest published snapshot, stays valid until the next
+		// acquire (if nothing new came in it's the same one again)
+		static auto acquire() -> const RenderSnapshot&;
+
+	private:
+		static void _extractEntity(core::Entity* entity, RenderSnapshot& snapshot,
+								   const RenderSnapshot& last);
+		static void _captureEntity(core::Entity* entity);
+
+		// low bits are the spare index, FreshBit is set when it holds something the
+		// render thread hasn't picked up yet
+		static constexpr uint8_t FreshBit = 0x4;
+
+		inline static RenderSnapshot buffers[3];
+		inline static std::atomic<uint8_t> spare{2};
+		inline static uint8_t back{0};	// tick thread only
+		inline static uint8_t last{1};	// tick thread only, what it published last
+		inline static uint8_t front{1}; // render thread only
+
+		// entity id -> index in the last snapshot, for entities that moved around
+		inline static std::unordered_map<uint32_t, uint32_t> lastIndex;
+
+		// only entities and world are filled in, used by the next extract if set
+		inline static RenderSnapshot captured;
+		inline static bool hasCapture{false};
+	};
+}
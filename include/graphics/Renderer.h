@@ -1,6 +1,7 @@
 #pragma once
 #include "graphics/GraphicContext.h"
 #include "graphics/RenderGraph.h"
+#include "graphics/RenderSnapshot.h"
 #include <memory>
 #include <vector>
 
@@ -9,6 +10,18 @@ namespace graphics
     class Renderer
     {
     public:
+        // what's being drawn this frame, render thread only
+        static auto getSnapshot() -> const RenderSnapshot*
+        {
+            return snapshot;
+        }
+
+        // blend factor between previousWorld and world
+        static auto getAlpha() -> float
+        {
+            return alpha;
+        }
+
     protected:
         static void init();
         static void shutdown();
@@ -17,6 +30,8 @@ namespace graphics
     private:
         inline static std::unique_ptr<GraphicContext> context;
         inline static std::vector<std::unique_ptr<RenderGraph>> graphs;
+        inline static const RenderSnapshot* snapshot{nullptr};
+        inline static float alpha{1.0F};
 
         friend class RenderThread;
     };
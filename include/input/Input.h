@@ -1,32 +1,110 @@
 #pragma once
+#include "input/InputEvent.h"
 #include "input/Scancode.h"
+#include "utils/SeqLock.h"
 #include "utils/math/Vector2.h"
+#include <atomic>
 #include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace core
 {
-    class Input
-    {
-    public:
+	// everything Input knows at the end of one tick. previous is the tick before, so
+	// "went down this tick" comes out of a single consistent copy
+	struct InputState
+	{
+		std::bitset<es_maxScancodes> keys;
+		std::bitset<es_maxScancodes> lastKeys;
+
+		std::bitset<es_maxMouseButtons> buttons;
+		std::bitset<es_maxMouseButtons> lastButtons;
+
+		float mouseX{0};
+		float mouseY{0};
+		float mouseDeltaX{0}; // over this tick
+		float mouseDeltaY{0};
+		float wheelX{0};
+		float wheelY{0};
+
+		uint64_t tick{0}; // Input's own tick count, what recordings are keyed on
+		uint64_t time{0}; // ns, steady clock, when it got published
+	};
+
+	// a raw event plus the tick it was applied in, replaying these tick by tick
+	// rebuilds exactly the same states
+	struct InputRecord
+	{
+		uint64_t tick{0};
+		InputEvent event;
+	};
+
+	// input as of the last tick. the tick thread applies whatever the event pump
+	// collected and publishes the result once per tick, reads from any thread are
+	// lock-free and always see one whole tick (never half of one)
+	class Input
+	{
+	public:
 		static auto getKey(Scancode key) -> bool;
 		static auto getKeyDown(Scancode key) -> bool;
 		static auto getKeyUp(Scancode key) -> bool;
 		static auto getButton(MouseButton button) -> bool;
 		static auto getButtonDown(MouseButton button) -> bool;
 		static auto getButtonUp(MouseButton button) -> bool;
-        static auto getMousePos() -> math::Vector2;
+		static auto getMousePos() -> math::Vector2;
+		static auto getMouseDelta() -> math::Vector2;
+		static auto getMouseWheel() -> math::Vector2;
+
+		// the whole thing, for anyone asking more than a couple of questions
+		static auto getState() -> InputState;
+
+		// raw events from `sequence` on (0 for as far back as there is), oldest first.
+		// returns the sequence to pass next time. anything older than the last
+		// HistorySize events is gone
+		static auto getHistory(uint64_t sequence, std::vector<InputRecord>& records)
+			-> uint64_t;
+
+		// feeds these in instead of live input, starting with the next tick. the
+		// first record's tick lines up with it and the rest keep their spacing
+		static void replay(std::vector<InputRecord> records);
+		static void stopReplay();
+		static auto isReplaying() -> bool
+		{
+			return replaying.load(std::memory_order_acquire);
+		}
 
 		static void setClipboard(const std::string& string);
 		static auto getClipboard() -> std::string;
 		static void openUrl(const std::string& url);
 
+		static constexpr size_t HistorySize = 4096;
+
 	private:
-		inline static std::bitset<es_maxScancodes> keys;
-		inline static std::bitset<es_maxScancodes> lastKeys;
+		// tick thread only, once per tick (catch-up ticks included, with no events)
+		static void advance(const std::vector<InputEvent>& events);
+		static void apply(const InputEvent& event);
+		static void record(const InputEvent& event);
+
+		// this thread's copy, only copied again once something newer got published
+		static auto current() -> const InputState&;
+
+		inline static utils::SeqLock<InputState> published;
+
+		// only touched by the tick thread
+		inline static InputState working;
+
+		inline static utils::AtomicWords<InputRecord> history[HistorySize];
+		inline static std::atomic<uint64_t> historyWritten{0};
 
-		inline static std::bitset<es_maxMouseButtons> buttons;
-		inline static std::bitset<es_maxMouseButtons> lastButtons;
+		inline static std::atomic<bool> replaying{false};
+		inline static std::atomic<bool> replayPending{false};
+		inline static std::vector<InputRecord> replayRecords; // guarded by the lock in Input.cpp
+		inline static std::vector<InputRecord> replayQueue;	  // tick thread only
+		inline static size_t replayPosition{0};
+		inline static int64_t replayOffset{0};
+		inline static std::vector<InputEvent> replayEvents;
 
-		inline static math::Vector2 mousePos;
+		friend class TickThread;
 	};
-}
\ No newline at end of file
+}
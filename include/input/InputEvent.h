@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+namespace core
+{
+	enum class InputEventType : uint8_t
+	{
+		KeyDown,
+		KeyUp,
+		MouseMotion,
+		MouseButtonDown,
+		MouseButtonUp,
+		MouseWheel,
+		ControllerButtonDown,
+		ControllerButtonUp,
+		ControllerAxis,
+		FocusLost, // whatever was held down isn't anymore, as far as we're concerned
+	};
+
+	// what the event pump hands the tick thread, one per raw event (consecutive mouse
+	// motion gets merged). 32 bytes, so a burst of a few hundred stays in a few pages
+	struct InputEvent
+	{
+		uint64_t time{0}; // ns, steady clock, when the pump picked it up
+		InputEventType type{InputEventType::KeyDown};
+		bool repeat{false}; // key held down long enough for the os to repeat it
+		uint16_t code{0};	// Scancode, MouseButton, or controller button/axis
+		uint16_t modifiers{0};
+		uint16_t device{0}; // controller instance, 0 for keyboard and mouse
+
+		// mouse position for motion/buttons, scroll amount for the wheel, axis value
+		// (-32768..32767) in x for controllers
+		int32_t x{0};
+		int32_t y{0};
+
+		// relative mouse motion, summed up over merged events
+		int32_t dx{0};
+		int32_t dy{0};
+	};
+
+	static_assert(sizeof(InputEvent) == 32, "keep InputEvent small, it's copied around a lot");
+}
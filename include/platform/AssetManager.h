@@ -1,9 +1,12 @@
 #pragma once
+#include "core/jobs/Task.h"
+#include "platform/AsyncIO.h"
 #include "utils/Demangle.h"
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <mutex>
 #include <optional>
@@ -71,10 +74,31 @@ namespace core
 		// loads a bundle file and indexes its contents
 		static auto loadBundle(const std::string& bundlePath) -> bool;
 
-		// retrieves an asset by its relative path
+		using LoadCallback = std::function<void(std::shared_ptr<Asset>)>;
+
+		// retrieves an asset by its relative path. the first call loads it, big (or
+		// deferred) assets come back as their processor's default asset while the read
+		// is in flight, and every call after that gets whatever is loaded by then
 		static auto getAsset(const std::string& path) -> std::shared_ptr<Asset>;
 		static auto assetExists(const std::string& path) -> bool;
 
+		// callback(asset) once the asset's data is in, with an empty pointer if it
+		// couldn't be loaded. starts loading it if nobody did yet. runs right away if
+		// it's already loaded, otherwise on the job that finishes the read
+		static void whenLoaded(const std::string& path, LoadCallback callback);
+
+		// starts reading all of these at once (a scene's worth, say). they show up as
+		// default assets until their data is in, `counter` hits 0 once they're all loaded.
+		// anything already loaded is skipped
+		static void preload(const std::vector<std::string>& paths,
+							jobs::JobCounter* counter = nullptr);
+
+#ifdef ES_COROUTINES
+		// `co_await AssetManager::loadAsync("...")` hands back the real asset once its
+		// data is in, instead of the default one. empty if it couldn't be loaded
+		static auto loadAsync(std::string path) -> jobs::Task<std::shared_ptr<Asset>>;
+#endif
+
 		// Clears all loaded bundles
 		static void clear();
 
@@ -104,12 +128,26 @@ namespace core
 			std::string bundlePath;	   // Source bundle file
 		};
 
-		static auto readAssetData(const AssetEntry& entry) -> std::shared_ptr<Asset>;
-		static auto readExternalData(const AssetEntry& entry) -> std::shared_ptr<Asset>;
+		static auto loadAsset(const AssetEntry& entry) -> std::shared_ptr<Asset>;
+		static auto getProcessor(const AssetEntry& entry) -> AssetProcessor*;
+		static auto openAssetFile(const AssetEntry& entry) -> platform::FileHandle;
+		static auto makeRequest(const AssetEntry& entry, AssetProcessor* loader,
+								platform::FileHandle file) -> platform::ReadRequest;
+
+		// expects mutex to be held. puts the default asset in place and marks the read as
+		// in flight, false if it's already loaded (or on its way)
+		static auto beginLoad(const AssetEntry& entry, AssetProcessor* loader) -> bool;
+
+		// a read finished, asset is empty if it failed
+		static void finishLoad(const std::string& path, const std::shared_ptr<Asset>& asset);
 
 		inline static std::unordered_map<std::string, AssetEntry> assetIndex;
 		inline static std::unordered_map<std::string, std::shared_ptr<Asset>>
 			loadedAssets;
+
+		// reads in flight, with whoever wants to know when they're done
+		inline static std::unordered_map<std::string, std::vector<LoadCallback>>
+			pendingAssets;
 		inline static std::vector<AssetProcessor*> processors;
 		inline static std::mutex mutex;
 	};
@@ -0,0 +1,121 @@
+#pragma once
+#include "core/jobs/JobCounter.h"
+#include "core/jobs/JobTypes.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace platform
+{
+	// file handle as returned by AsyncIO::openFile. a plain fd everywhere but windows
+	using FileHandle = intptr_t;
+	constexpr FileHandle InvalidFileHandle = -1;
+
+	struct ReadRequest
+	{
+		FileHandle file{InvalidFileHandle};
+		uint64_t offset{0};
+		uint64_t size{0};
+		char* buffer{nullptr};
+
+		// gets the number of bytes read (short on eof) or -errno. runs as a job at
+		// `priority`, never on the thread that completed the read (unless the job system
+		// is shutting down and won't take it, then it runs right there)
+		std::function<void(int64_t)> onComplete;
+		core::jobs::JobPriority priority{core::jobs::JobPriority::Normal};
+
+		// decremented after onComplete returns
+		core::jobs::JobCounter* counter{nullptr};
+	};
+
+	// mapped io_uring state, only ever filled in on linux
+	struct IoRing
+	{
+		int fd{-1};
+		uint32_t entries{0};
+
+		void* sqMemory{nullptr};
+		size_t sqMemorySize{0};
+		void* cqMemory{nullptr};
+		size_t cqMemorySize{0};
+		void* sqeMemory{nullptr};
+		size_t sqeMemorySize{0};
+
+		uint32_t* sqHead{nullptr};
+		uint32_t* sqTail{nullptr};
+		uint32_t* sqMask{nullptr};
+		uint32_t* sqArray{nullptr};
+		uint32_t* cqHead{nullptr};
+		uint32_t* cqTail{nullptr};
+		uint32_t* cqMask{nullptr};
+		void* cqes{nullptr};
+		void* sqes{nullptr};
+	};
+
+	// async file reads. on linux this goes through io_uring (raw syscalls, no liburing),
+	// everywhere else (or when the kernel says no, which happens a lot in containers)
+	// reads run as blocking-lane jobs on the job system. either way completions come
+	// back as jobs, nothing here blocks the caller
+	class AsyncIO
+	{
+	public:
+		static void initialize();
+
+		// waits for reads that are still on the blocking lane, so it goes before the
+		// job system's shutdown. anything read() gets after this fails with -ECANCELED
+		static void shutdown();
+
+		// files stay open until shutdown, so reading a hundred assets out of the same
+		// bundle only opens it once
+		static auto openFile(const std::string& path) -> FileHandle;
+		static void closeFiles();
+
+		static void read(ReadRequest request);
+
+		// requests are sorted by file and offset, and back-to-back ranges in the same
+		// file get merged into a single vectored read. this is what you want for bundles
+		static void read(std::vector<ReadRequest>& requests);
+
+		// plain blocking positional read, for small stuff that has to be there right now
+		static auto readNow(FileHandle file, uint64_t offset, uint64_t size, char* buffer)
+			-> int64_t;
+
+		static auto usingIoUring() -> bool
+		{
+			return ring.fd >= 0;
+		}
+
+	protected:
+		// one submission: a run of contiguous requests against the same file
+		struct ReadGroup;
+
+		static auto setupRing(uint32_t entries) -> bool;
+		static void destroyRing();
+		static void submitGroups(std::vector<ReadGroup*>& groups);
+		static void reapCompletions();
+
+		// reads the group on the blocking lane. if that job never runs, the group is
+		// completed with -ECANCELED instead
+		static void submitGroupJob(ReadGroup* group);
+		static void runGroup(core::jobs::Job* job, void* data);
+		static void cancelGroup(void* data);
+		static void completeGroup(ReadGroup* group, int64_t result);
+
+		inline static IoRing ring;
+		inline static std::mutex submitMutex;
+		inline static std::thread completionThread;
+		inline static std::atomic<bool> stopping{false};
+
+		// groups on the blocking lane (queued or running) plus reads being set up.
+		// shutdown waits for it to hit 0 before closing the files
+		inline static std::atomic<uint32_t> pendingGroups{0};
+
+		inline static std::unordered_map<std::string, FileHandle> files;
+		inline static std::mutex filesMutex;
+	};
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace platform
+{
+	// a cpu the os schedules on (a hardware thread). only the ones this process is
+	// allowed to run on show up, so taskset/cgroup limits are respected
+	struct LogicalCpu
+	{
+		uint32_t id{0};		  // what the os calls it (cpuN)
+		uint32_t core{0};	  // index into CpuLayout::cores
+		uint32_t node{0};	  // numa node
+		uint32_t sibling{0};  // 0 for the first hardware thread of its core, 1 for the next...
+	};
+
+	struct PhysicalCore
+	{
+		uint32_t package{0};
+		uint32_t node{0};
+		std::vector<uint32_t> cpus; // smt siblings, by os id
+	};
+
+	struct NumaNode
+	{
+		uint32_t id{0};
+		std::vector<uint32_t> cpus;
+	};
+
+	struct CpuLayout
+	{
+		std::vector<LogicalCpu> cpus;
+		std::vector<PhysicalCore> cores; // sorted by node, then package
+		std::vector<NumaNode> nodes;
+
+		[[nodiscard]] auto smtWidth() const -> uint32_t;
+	};
+
+	enum class WorkerPlacement : char
+	{
+		PerPhysicalCore, // one worker per core, free to use any of its siblings
+		PerLogicalCpu,	 // one worker per hardware thread, first siblings first
+	};
+
+	// how the engine spreads its threads over the machine. set it before the
+	// application is created, the job system sizes itself from it
+	struct PlacementPolicy
+	{
+		// each of these takes a physical core away from the workers (if there's enough
+		// of them to go around, otherwise they just don't get a core of their own)
+		bool reserveMain{true};
+		bool reserveRender{false};
+		bool reserveTick{false};
+
+		// per logical cpu is the closest to the old "every cpu but one" pool
+		WorkerPlacement workers{WorkerPlacement::PerLogicalCpu};
+
+		// when several instances share a host, each one gets its own slice of the
+		// cores (split along numa nodes where possible) instead of all of them piling
+		// onto cpu 0..n
+		uint32_t instanceIndex{0};
+		uint32_t instanceCount{1};
+
+		// false works out the counts but leaves scheduling to the os
+		bool pinThreads{true};
+	};
+
+	enum class ThreadRole : char
+	{
+		Main,
+		Render,
+		Tick,
+		Worker
+	};
+
+	// cpu sets for every thread the engine owns, empty means "don't pin"
+	struct ThreadPlacement
+	{
+		std::vector<uint32_t> main;
+		std::vector<uint32_t> render;
+		std::vector<uint32_t> tick;
+		std::vector<std::vector<uint32_t>> workers;
+	};
+
+	class CpuTopology
+	{
+	public:
+		// reads /sys/devices/system/cpu (and /sys/devices/system/node) once, every
+		// cpu is its own core on platforms where that isn't there
+		static auto getLayout() -> const CpuLayout&;
+
+		static void setPolicy(const PlacementPolicy& policy);
+		static auto getPolicy() -> PlacementPolicy;
+		static auto getPlacement() -> ThreadPlacement;
+
+		// how many job workers the current policy asks for
+		static auto workerCount() -> size_t;
+
+		// pins the calling thread according to its role. workers wrap around if there's
+		// more of them than the policy planned for
+		static void applyToCurrentThread(ThreadRole role, size_t index = 0);
+
+		static auto describe() -> std::string;
+
+	private:
+		static auto detect() -> CpuLayout;
+		static auto computePlacement(const CpuLayout& layout, const PlacementPolicy& policy)
+			-> ThreadPlacement;
+		static auto pinCurrentThread(const std::vector<uint32_t>& cpus) -> bool;
+
+		inline static std::mutex mutex;
+		inline static bool detected{false};
+		inline static CpuLayout layout;
+		inline static PlacementPolicy policy;
+		inline static bool placed{false};
+		inline static ThreadPlacement placement;
+	};
+}
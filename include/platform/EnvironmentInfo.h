@@ -61,6 +61,8 @@ namespace platform
 		std::string osVersion;		// operating system version
 		std::string cpuBrand;		// cpu info
 		uint32_t cpuCores = 0;		// well, cpu cores duh
+		uint32_t physicalCores = 0; // without smt siblings, see CpuTopology
+		uint32_t numaNodes = 0;
 		uint64_t totalMemoryMB = 0; // this is getting redundant
 		uint64_t availableMemoryMB = 0;
 	};
@@ -0,0 +1,56 @@
+#pragma once
+#include "input/InputEvent.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+union SDL_Event;
+
+namespace platform
+{
+	// main thread side of input. every frame it takes everything sdl has queued in one
+	// go, deals with window/app events itself and turns input into compact
+	// InputEvents for the tick thread. with nothing to do it sleeps in sdl until
+	// something comes in or the frame budget runs out, instead of spinning
+	class EventPump
+	{
+	public:
+		// main thread only. returns how many events it went through
+		static auto pump() -> size_t;
+
+		// how long pump() may block when there are no events, so the main loop still
+		// comes around (frame bookkeeping, window state) this often. 0 never blocks
+		static void setFrameBudget(std::chrono::microseconds budget);
+		static auto getFrameBudget() -> std::chrono::microseconds;
+
+		// tick thread: swaps everything pumped since the last call into `events`
+		// (which gets cleared first). one lock per call, not per event
+		static void consume(std::vector<core::InputEvent>& events);
+
+		// events thrown away because the tick thread wasn't picking them up
+		static auto getDroppedCount() -> uint64_t
+		{
+			return dropped.load(std::memory_order_relaxed);
+		}
+
+		// more than this waiting for the tick thread and the oldest go
+		static constexpr size_t MaxPendingEvents = 4096;
+
+	private:
+		static auto drain() -> size_t;
+		static void translate(const SDL_Event& event, uint64_t time);
+		static void publish();
+
+		// filled by the main thread, swapped with `pending` once per pump
+		inline static std::vector<core::InputEvent> batch;
+
+		inline static std::mutex lock;
+		inline static std::vector<core::InputEvent> pending;
+
+		inline static std::atomic<int64_t> frameBudget{8333}; // us, ~120hz
+		inline static std::chrono::steady_clock::time_point frameStart;
+		inline static std::atomic<uint64_t> dropped{0};
+	};
+}
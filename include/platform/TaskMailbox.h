@@ -0,0 +1,249 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace platform
+{
+	// move-only void() callable that keeps small captures inline instead of going to
+	// the heap like std::function does. anything bigger than the buffer (or that could
+	// throw while moving) still gets allocated, so keep captures small on hot paths
+	class InlineTask
+	{
+	public:
+		static constexpr size_t BufferSize = 48;
+
+		InlineTask() = default;
+
+		template <typename Fn, typename = std::enable_if_t<
+								   !std::is_same_v<std::decay_t<Fn>, InlineTask>>>
+		InlineTask(Fn&& fn) // NOLINT: implicit on purpose, so lambdas just go in
+		{
+			using T = std::decay_t<Fn>;
+			if constexpr (fitsInline<T>())
+			{
+				new (_buffer) T(std::forward<Fn>(fn));
+				_ops = &inlineOps<T>;
+			}
+			else
+			{
+				*reinterpret_cast<T**>(_buffer) = new T(std::forward<Fn>(fn));
+				_ops = &heapOps<T>;
+			}
+		}
+
+		InlineTask(const InlineTask&) = delete;
+		auto operator=(const InlineTask&) -> InlineTask& = delete;
+
+		InlineTask(InlineTask&& other) noexcept
+		{
+			_take(other);
+		}
+
+		auto operator=(InlineTask&& other) noexcept -> InlineTask&
+		{
+			if (this != &other)
+			{
+				_reset();
+				_take(other);
+			}
+			return *this;
+		}
+
+		~InlineTask()
+		{
+			_reset();
+		}
+
+		void operator()()
+		{
+			_ops->invoke(_buffer);
+		}
+
+		explicit operator bool() const
+		{
+			return _ops != nullptr;
+		}
+
+	private:
+		struct Ops
+		{
+			void (*invoke)(void* buffer);
+			void (*move)(void* from, void* to);
+			void (*destroy)(void* buffer);
+		};
+
+		template <typename T> static constexpr auto fitsInline() -> bool
+		{
+			return sizeof(T) <= BufferSize && alignof(T) <= alignof(std::max_align_t) &&
+				   std::is_nothrow_move_constructible_v<T>;
+		}
+
+		template <typename T>
+		inline static constexpr Ops inlineOps{
+			[](void* buffer) { (*static_cast<T*>(buffer))(); },
+			[](void* from, void* to)
+			{
+				new (to) T(std::move(*static_cast<T*>(from)));
+				static_cast<T*>(from)->~T();
+			},
+			[](void* buffer) { static_cast<T*>(buffer)->~T(); },
+		};
+
+		template <typename T>
+		inline static constexpr Ops heapOps{
+			[](void* buffer) { (**static_cast<T**>(buffer))(); },
+			[](void* from, void* to) { *static_cast<T**>(to) = *static_cast<T**>(from); },
+			[](void* buffer) { delete *static_cast<T**>(buffer); },
+		};
+
+		void _take(InlineTask& other)
+		{
+			_ops = other._ops;
+			if (_ops != nullptr)
+			{
+				_ops->move(other._buffer, _buffer);
+				other._ops = nullptr;
+			}
+		}
+
+		void _reset()
+		{
+			if (_ops != nullptr)
+			{
+				_ops->destroy(_buffer);
+				_ops = nullptr;
+			}
+		}
+
+		alignas(std::max_align_t) unsigned char _buffer[BufferSize];
+		const Ops* _ops{nullptr};
+	};
+
+	// bounded multi-producer single-consumer queue of tasks (Vyukov's bounded queue,
+	// with the consumer side simplified since there's only one). slots are allocated
+	// once up front, so pushing never allocates and never takes a lock
+	class TaskMailbox
+	{
+	public:
+		explicit TaskMailbox(size_t capacity = 1024)
+		{
+			size_t rounded = 1;
+			while (rounded < capacity)
+			{
+				rounded <<= 1;
+			}
+
+			_mask = rounded - 1;
+			_slots = std::make_unique<Slot[]>(rounded);
+			for (size_t i = 0; i < rounded; i++)
+			{
+				_slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		TaskMailbox(const TaskMailbox&) = delete;
+		auto operator=(const TaskMailbox&) -> TaskMailbox& = delete;
+
+		// any thread. false if the mailbox is full, the task is left untouched then
+		auto tryPush(InlineTask& task) -> bool
+		{
+			size_t position = _tail.load(std::memory_order_relaxed);
+			Slot* slot = nullptr;
+
+			while (true)
+			{
+				slot = &_slots[position & _mask];
+				size_t sequence = slot->sequence.load(std::memory_order_acquire);
+				auto diff = (intptr_t)sequence - (intptr_t)position;
+
+				if (diff == 0)
+				{
+					if (_tail.compare_exchange_weak(position, position + 1,
+													std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (diff < 0)
+				{
+					// the consumer hasn't gotten around to this slot yet, we're full
+					return false;
+				}
+				else
+				{
+					position = _tail.load(std::memory_order_relaxed);
+				}
+			}
+
+			slot->task = std::move(task);
+			slot->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		// owner only
+		auto tryPop(InlineTask& task) -> bool
+		{
+			size_t head = _head.load(std::memory_order_relaxed);
+			Slot& slot = _slots[head & _mask];
+			if (slot.sequence.load(std::memory_order_acquire) != head + 1)
+			{
+				return false;
+			}
+
+			task = std::move(slot.task);
+			slot.sequence.store(head + _mask + 1, std::memory_order_release);
+			_head.store(head + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// owner only. runs whatever was queued when it started, tasks queued by those
+		// tasks wait for the next drain. the slot is handed back before the task runs,
+		// so producers never wait on a task that's executing
+		auto drain() -> size_t
+		{
+			size_t pending =
+				_tail.load(std::memory_order_acquire) - _head.load(std::memory_order_relaxed);
+			size_t executed = 0;
+
+			InlineTask task;
+			while (executed < pending && tryPop(task))
+			{
+				task();
+				task = InlineTask();
+				executed++;
+			}
+
+			return executed;
+		}
+
+		[[nodiscard]] auto sizeApprox() const -> size_t
+		{
+			size_t tail = _tail.load(std::memory_order_relaxed);
+			size_t head = _head.load(std::memory_order_relaxed);
+			return tail > head ? tail - head : 0;
+		}
+
+		[[nodiscard]] auto capacity() const -> size_t
+		{
+			return _mask + 1;
+		}
+
+	private:
+		struct alignas(64) Slot
+		{
+			std::atomic<size_t> sequence{0};
+			InlineTask task;
+		};
+
+		std::unique_ptr<Slot[]> _slots;
+		size_t _mask{0};
+
+		alignas(64) std::atomic<size_t> _tail{0};
+		alignas(64) std::atomic<size_t> _head{0}; // only written by the owner
+	};
+}
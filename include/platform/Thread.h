@@ -1,9 +1,10 @@
 #pragma once
+#include "platform/TaskMailbox.h"
 #include <atomic>
-#include <functional>
+#include <future>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <type_traits>
 
 namespace platform
 {
@@ -45,18 +46,59 @@ namespace platform
 		void join();
 		void terminate();
 
-		void submitTask(const std::function<void()>& task);
+		// runs `fn` on this thread at the start of its next update, fire and forget.
+		// small captures don't allocate, and it's safe to call from any thread
+		template <typename Fn> void postTask(Fn&& fn)
+		{
+			InlineTask task(std::forward<Fn>(fn));
+			_post(task);
+		}
+
+		// same, but hands back a future for the result. don't wait on it from this
+		// same thread, it only runs once the current update returns
+		template <typename Fn> auto submitTask(Fn&& fn) -> std::future<std::invoke_result_t<Fn>>
+		{
+			using Result = std::invoke_result_t<Fn>;
+
+			std::promise<Result> promise;
+			auto future = promise.get_future();
+
+			postTask(
+				[fn = std::forward<Fn>(fn), promise = std::move(promise)]() mutable
+				{
+					try
+					{
+						if constexpr (std::is_void_v<Result>)
+						{
+							fn();
+							promise.set_value();
+						}
+						else
+						{
+							promise.set_value(fn());
+						}
+					}
+					catch (...)
+					{
+						promise.set_exception(std::current_exception());
+					}
+				});
+
+			return future;
+		}
+
         static auto getTime() -> ThreadTime&;
 
 	protected:
 		std::thread thread;
 		std::mutex mutex;
 		std::atomic<bool> running{true};
-		std::queue<std::function<void()>> workQueue;
+		TaskMailbox mailbox{1024};
 
 		void executeWorkQueue();
 
 	private:
 		void _run();
+		void _post(InlineTask& task);
 	};
 }
\ No newline at end of file
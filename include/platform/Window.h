@@ -1,6 +1,8 @@
 #pragma once
 #include "SDL2/SDL_video.h"
 #include "utils/math/Vector2.h"
+#include <atomic>
+#include <cstdint>
 #include <string>
 
 namespace platform
@@ -20,6 +22,7 @@ namespace platform
 		void setMinSize(int width, int height);
 		void setMaxSize(int width, int height);
 
+		// safe from any thread (the tick thread reads it for the cameras)
 		[[nodiscard]] auto getSize() const -> math::Vector2;
 		[[nodiscard]] auto getPosition() const -> math::Vector2;
 
@@ -34,9 +37,13 @@ namespace platform
 		auto getWindowHandle() -> void*;
 
 	private:
+		// main thread only, publishes the new size for getSize
+		void _setSize(int width, int height);
+
 		std::string _title;
 		int _width;
 		int _height;
+		std::atomic<uint64_t> _publishedSize{0}; // width << 32 | height
 		int _xPos;
 		int _yPos;
 		bool _vsync{true};
@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace utils
+{
+	// a trivially copyable value kept as relaxed atomic words, so a reader racing a
+	// writer gets torn data (which the caller is expected to detect) instead of a
+	// data race. on x86 and arm these are plain loads and stores
+	template <typename T> class AtomicWords
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "AtomicWords needs a trivially copyable type");
+
+	public:
+		static constexpr size_t WordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+		void store(const T& value)
+		{
+			uint64_t words[WordCount]{};
+			std::memcpy(words, &value, sizeof(T));
+			for (size_t i = 0; i < WordCount; i++)
+			{
+				_words[i].store(words[i], std::memory_order_relaxed);
+			}
+		}
+
+		void load(T& value) const
+		{
+			uint64_t words[WordCount];
+			for (size_t i = 0; i < WordCount; i++)
+			{
+				words[i] = _words[i].load(std::memory_order_relaxed);
+			}
+			std::memcpy(&value, words, sizeof(T));
+		}
+
+	private:
+		std::atomic<uint64_t> _words[WordCount]{};
+	};
+
+	// one writer, any number of readers that never block it. readers retry if the
+	// writer was halfway through, which only happens if they read at the exact moment
+	// it publishes. meant for small state that changes a few times a frame at most
+	template <typename T> class SeqLock
+	{
+	public:
+		// single writer only
+		void store(const T& value)
+		{
+			uint64_t sequence = _sequence.load(std::memory_order_relaxed);
+			_sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			_value.store(value);
+			_sequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		// returns the version it read, which only ever goes up
+		auto load(T& value) const -> uint64_t
+		{
+			while (true)
+			{
+				uint64_t before = _sequence.load(std::memory_order_acquire);
+				if ((before & 1) != 0)
+				{
+					continue;
+				}
+
+				_value.load(value);
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if (_sequence.load(std::memory_order_relaxed) == before)
+				{
+					return before;
+				}
+			}
+		}
+
+		// cheap check for whether there's anything newer than what a reader has
+		[[nodiscard]] auto version() const -> uint64_t
+		{
+			return _sequence.load(std::memory_order_acquire);
+		}
+
+	private:
+		std::atomic<uint64_t> _sequence{0};
+		AtomicWords<T> _value;
+	};
+}
@@ -71,9 +71,11 @@ namespace math
 			Matrix4 result;
 			std::vector<mat4*> rawMatrices;
 			rawMatrices.reserve(matrices.size());
-			for (auto matrix : matrices)
+			for (const auto& matrix : matrices)
 			{
-				rawMatrices.push_back(&matrix.raw);
+				// not a copy, those would all be gone (and share one address) by the
+				// time mulN reads them
+				rawMatrices.push_back(const_cast<mat4*>(&matrix.raw));
 			}
 			glm_mat4_mulN(rawMatrices.data(), rawMatrices.size(), result.raw);
 			return result;
@@ -0,0 +1,74 @@
+#pragma once
+#include "utils/math/Matrix4.h"
+#include "utils/math/Quaternion.h"
+#include "utils/math/TransformKernel.h"
+#include "utils/math/Vector3.h"
+#include <cstddef>
+#include <vector>
+
+namespace math
+{
+	// translation * rotation * scale, same thing the batched kernels compute for
+	// each transform
+	auto composeTRS(const Vector3& position, const Quaternion& rotation, const Vector3& scale)
+		-> Matrix4;
+
+	// out[i] = translation * rotation * scale for `count` transforms
+	void composeLocalMatrices(const TransformStreams& local, Matrix4* out, size_t count);
+
+	// out[i] = parents[i] * local[i], a null parent counts as identity (roots). out
+	// can't overlap any of the parents
+	void composeWorldMatrices(const TransformStreams& local, const Matrix4* const* parents,
+							  Matrix4* out, size_t count);
+
+	// how many transforms the kernels do at once on this machine: 8 with avx2, 4
+	// with sse or neon, 1 without any of them
+	auto getTransformBatchWidth() -> size_t;
+
+	// owns the streams, for systems that keep their transforms as a batch to begin
+	// with instead of gathering them from somewhere every time
+	class TransformBatch
+	{
+	public:
+		void resize(size_t count);
+
+		[[nodiscard]] auto size() const -> size_t
+		{
+			return _count;
+		}
+
+		void set(size_t index, const Vector3& position, const Quaternion& rotation,
+				 const Vector3& scale);
+
+		[[nodiscard]] auto getStreams() const -> TransformStreams;
+
+		void computeLocal(Matrix4* out) const
+		{
+			composeLocalMatrices(getStreams(), out, _count);
+		}
+
+		void computeWorld(const Matrix4* const* parents, Matrix4* out) const
+		{
+			composeWorldMatrices(getStreams(), parents, out, _count);
+		}
+
+	private:
+		enum Stream
+		{
+			PositionX,
+			PositionY,
+			PositionZ,
+			RotationX,
+			RotationY,
+			RotationZ,
+			RotationW,
+			ScaleX,
+			ScaleY,
+			ScaleZ,
+			StreamCount,
+		};
+
+		std::vector<float> _streams[StreamCount];
+		size_t _count{0};
+	};
+}
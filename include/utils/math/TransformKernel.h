@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+
+// nothing in here may pull in inline code from elsewhere (cglm, Matrix4, <cmath>),
+// the avx2 kernels include it with avx2 turned on and the linker would be free to
+// keep those copies for everybody else
+
+namespace math
+{
+	struct Matrix4;
+
+	// local position/rotation/scale of a batch of transforms, one float array per
+	// component. that's what lets the kernels do 4 or 8 transforms per instruction
+	// instead of one
+	struct TransformStreams
+	{
+		const float* positionX{nullptr};
+		const float* positionY{nullptr};
+		const float* positionZ{nullptr};
+
+		const float* rotationX{nullptr};
+		const float* rotationY{nullptr};
+		const float* rotationZ{nullptr};
+		const float* rotationW{nullptr};
+
+		const float* scaleX{nullptr};
+		const float* scaleY{nullptr};
+		const float* scaleZ{nullptr};
+	};
+
+	namespace internals
+	{
+		// translation * rotation * scale for V::Width transforms at once, as
+		// m[column][row] (the bottom row is always 0 0 0 1). the rotation part is the
+		// same math as glm_quat_mat4, so results match the per-object path
+		template <typename V>
+		inline void composeLanes(const TransformStreams& local, size_t i, V (&m)[4][3])
+		{
+			V x = V::load(local.rotationX + i);
+			V y = V::load(local.rotationY + i);
+			V z = V::load(local.rotationZ + i);
+			V w = V::load(local.rotationW + i);
+
+			// a zero quaternion zeroes every product below anyway, the max only keeps
+			// the division finite
+			V norm = V::sqrt(x * x + y * y + z * z + w * w);
+			V s = V::set(2.0F) / V::max(norm, V::set(1e-30F));
+
+			V xx = s * x * x;
+			V xy = s * x * y;
+			V wx = s * w * x;
+			V yy = s * y * y;
+			V yz = s * y * z;
+			V wy = s * w * y;
+			V zz = s * z * z;
+			V xz = s * x * z;
+			V wz = s * w * z;
+
+			V one = V::set(1.0F);
+			V scaleX = V::load(local.scaleX + i);
+			V scaleY = V::load(local.scaleY + i);
+			V scaleZ = V::load(local.scaleZ + i);
+
+			m[0][0] = (one - yy - zz) * scaleX;
+			m[0][1] = (xy + wz) * scaleX;
+			m[0][2] = (xz - wy) * scaleX;
+
+			m[1][0] = (xy - wz) * scaleY;
+			m[1][1] = (one - xx - zz) * scaleY;
+			m[1][2] = (yz + wx) * scaleY;
+
+			m[2][0] = (xz + wy) * scaleZ;
+			m[2][1] = (yz - wx) * scaleZ;
+			m[2][2] = (one - xx - yy) * scaleZ;
+
+			m[3][0] = V::load(local.positionX + i);
+			m[3][1] = V::load(local.positionY + i);
+			m[3][2] = V::load(local.positionZ + i);
+		}
+
+		// goes as far as whole groups of V::Width go and returns how many it did, the
+		// rest is up to the caller. matrices are 16 floats, column major
+		template <typename V>
+		inline auto composeTransforms(const TransformStreams& local, const Matrix4* const* parents,
+									  Matrix4* out, size_t count) -> size_t
+		{
+			auto* matrices = reinterpret_cast<float*>(out);
+
+			size_t i = 0;
+			for (; i + V::Width <= count; i += V::Width)
+			{
+				V m[4][3];
+				composeLanes(local, i, m);
+				V::store(m, matrices + i * 16);
+
+				if (parents == nullptr)
+				{
+					continue;
+				}
+
+				for (size_t lane = 0; lane < V::Width; lane++)
+				{
+					if (parents[i + lane] != nullptr)
+					{
+						V::mulParent(reinterpret_cast<const float*>(parents[i + lane]),
+									 matrices + (i + lane) * 16);
+					}
+				}
+			}
+
+			return i;
+		}
+
+		// built with avx2 and fma turned on, only for cpus that have both
+		auto composeTransformsAvx2(const TransformStreams& local, const Matrix4* const* parents,
+								   Matrix4* out, size_t count) -> size_t;
+	}
+}
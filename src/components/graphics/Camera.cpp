@@ -186,6 +186,16 @@ namespace core
 		return _sensorAspect;
 	}
 
+	auto Camera::getView() const -> math::Matrix4
+	{
+		return _view;
+	}
+
+	auto Camera::getProjection() const -> math::Matrix4
+	{
+		return _projection;
+	}
+
 	void Camera::setViewportSize(math::Vector2 viewport)
 	{
         if (viewportSize == viewport)
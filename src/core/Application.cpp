@@ -7,9 +7,10 @@
 #include "core/log.h"
 #include "graphics/RenderThread.h"
 #include "platform/AssetManager.h"
+#include "platform/AsyncIO.h"
+#include "platform/CpuTopology.h"
 #include "platform/EnvironmentInfo.h"
-#include "platform/EventHandler.h"
-#include "platform/JobScheduler.h"
+#include "platform/EventPump.h"
 #include "platform/ThreadManager.h"
 #include "platform/assets/LuaScript.h"
 #include "utils/PerformanceTimer.h"
@@ -31,33 +32,31 @@ namespace core
 		main = this;
 
 		envInfo = std::make_unique<platform::EnvironmentInfo>();
-		frameMemoryPool = std::make_unique<jobs::FrameMemoryPool>();
 		jobs::JobManager::initialize();
+		platform::AsyncIO::initialize();
 
 		AssetManager::registerProcessor<platform::LuaScriptProcessor>();
 		LuaScriptEngine::init();
 
-		::internals::JobScheduler::init();
 		AssetManager::init();
 
 		platform::ThreadManager::addThread<graphics::RenderThread>();
 		platform::ThreadManager::addThread<core::TickThread>();
+
+		// last, so nothing spawned above inherits main's affinity
+		platform::CpuTopology::applyToCurrentThread(platform::ThreadRole::Main);
+		log_info("cpu topology: %s", platform::CpuTopology::describe().c_str());
 	}
 
 	auto Application::run() -> bool
 	{
-		SDL_Event e;
-
 		while (window->isRunning())
 		{
 			core::time.startMeasure();
-			frameMemoryPool->reset();
 			jobs::JobManager::beginFrame();
 
-			if (SDL_PollEvent(&e) == 1)
-			{
-				::internals::handleEvent(e);
-			}
+			// everything that came in since last time, or a nap until something does
+			platform::EventPump::pump();
 
 			jobs::JobManager::endFrame();
 			core::time.endMeasure();
@@ -70,7 +69,7 @@ namespace core
 	{
 		shutdown();
 		platform::ThreadManager::shutdown();
-		::internals::JobScheduler::shutdown();
+		platform::AsyncIO::shutdown();
 		jobs::JobManager::shutdown();
 		LuaScriptEngine::shutdown();
 		window.reset();
@@ -112,6 +111,11 @@ namespace core
 		return window.get();
 	}
 
+	auto Application::getFrameMemoryPool() -> jobs::FrameMemoryPool*
+	{
+		return jobs::JobManager::getFrameMemory();
+	}
+
 	auto Application::hasInit() const -> bool
 	{
 		return _init;
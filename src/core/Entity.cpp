@@ -0,0 +1,125 @@
+#include "core/Entity.h"
+#include "core/Scene.h"
+#include "core/log.h"
+
+namespace core
+{
+	Entity::~Entity()
+	{
+		if (_world != nullptr)
+		{
+			_world->destroy(_dataID);
+		}
+
+		if (_scene != nullptr)
+		{
+			_scene->_unregisterEntity(this);
+		}
+	}
+
+	auto Entity::getChild(unsigned int id) const -> Entity*
+	{
+		if (_scene != nullptr)
+		{
+			auto* entity = _scene->getEntity(id);
+			return entity != nullptr && entity->_parent == this ? entity : nullptr;
+		}
+
+		for (const auto& child : _children)
+		{
+			if (child->_entityID == id)
+			{
+				return child.get();
+			}
+		}
+		return nullptr;
+	}
+
+	auto Entity::getChild(const std::string& name) const -> Entity*
+	{
+		if (_scene != nullptr)
+		{
+			return _scene->_findChild(this, name);
+		}
+
+		for (const auto& child : _children)
+		{
+			if (child->_entityName == name)
+			{
+				return child.get();
+			}
+		}
+		return nullptr;
+	}
+
+	void Entity::setTag(char entityTag)
+	{
+		if (_scene != nullptr)
+		{
+			_scene->_retagEntity(this, (unsigned char)entityTag);
+		}
+		else
+		{
+			_entityTag = entityTag;
+		}
+	}
+
+	void Entity::setName(const std::string& name)
+	{
+		if (_scene != nullptr)
+		{
+			_scene->_renameEntity(this, name);
+		}
+		else
+		{
+			_entityName = name;
+		}
+	}
+
+	void Entity::_hierarchyChanged()
+	{
+		if (_scene != nullptr)
+		{
+			_scene->_hierarchy.invalidate();
+		}
+	}
+
+	void Entity::_setScene(Scene* scene)
+	{
+		if (_scene == scene)
+		{
+			return;
+		}
+
+		if (_scene != nullptr)
+		{
+			if (_world != nullptr && _world->isAlive(_dataID))
+			{
+				// different scene, different chunks. nothing to carry it over with
+				if (scene != nullptr)
+				{
+					log_warn("entity \"%s\" changed scenes, its data components are gone",
+							 _entityName.c_str());
+				}
+
+				_world->destroy(_dataID);
+				_dataID = {};
+			}
+
+			_scene->_unregisterEntity(this);
+		}
+
+		_scene = scene;
+		_world = scene != nullptr ? &scene->getWorld() : nullptr;
+
+		if (scene != nullptr)
+		{
+			scene->_registerEntity(this);
+		}
+
+		for (const auto& child : _children)
+		{
+			child->_setScene(scene);
+		}
+	}
+}
@@ -2,6 +2,7 @@
 #include "core/Application.h"
 #include "core/Entity.h"
 #include "core/log.h"
+#include <algorithm>
 #include <utility>
 
 namespace core
@@ -18,94 +19,214 @@ namespace core
 
 	auto Scene::getEntity(unsigned int id) -> Entity*
 	{
-		for (const auto& entity : _entities)
+		auto it = _byID.find(id);
+		return it != _byID.end() ? it->second : nullptr;
+	}
+
+	auto Scene::getEntity(const std::string& name) -> Entity*
+	{
+		auto it = _byName.find(name);
+		return it != _byName.end() && !it->second.empty() ? it->second.front() : nullptr;
+	}
+
+	auto Scene::getEntities(const char& tag) -> std::vector<Entity*>
+	{
+		auto it = _byTag.find((unsigned char)tag);
+		return it != _byTag.end() ? it->second : std::vector<Entity*>();
+	}
+
+	auto Scene::getEntity(EntityHandle handle) -> Entity*
+	{
+		return isValid(handle) ? _slots[handle.index].entity : nullptr;
+	}
+
+	auto Scene::removeEntity(Entity* entity) -> void
+	{
+		if (entity == nullptr || entity->_scene != this)
 		{
-			if (entity->getID() == id)
-			{
-				return entity.get();
-			}
+			return;
+		}
+
+		// children belong to their parent, the scene only owns the roots
+		if (Entity* parent = entity->getParent())
+		{
+			parent->removeChild(entity);
+			return;
+		}
+
+		auto it = std::find_if(_entities.begin(), _entities.end(),
+							   [entity](const auto& root) { return root.get() == entity; });
+		if (it != _entities.end())
+		{
+			(*it)->setActive(false);
+			_entities.erase(it);
 		}
-		return nullptr;
 	}
 
-	auto Scene::getEntity(const std::string& name) -> Entity*
+	auto Scene::removeEntity(EntityHandle handle) -> void
 	{
-		for (const auto& entity : _entities)
+		removeEntity(getEntity(handle));
+	}
+
+	auto Scene::removeEntity(unsigned int id) -> void
+	{
+		removeEntity(getEntity(id));
+	}
+
+	auto Scene::removeEntity(const std::string& name) -> void
+	{
+		removeEntity(getEntity(name));
+	}
+
+	auto Scene::removeEntities(const char& tag) -> void
+	{
+		// handles, since taking out a parent takes its children (maybe in this list too)
+		// with it
+		std::vector<EntityHandle> handles;
+		for (auto* entity : getEntities(tag))
 		{
-			if (entity->getName() == name)
-			{
-				return entity.get();
-			}
+			handles.push_back(entity->_handle);
+		}
+
+		for (auto handle : handles)
+		{
+			removeEntity(handle);
 		}
-		return nullptr;
 	}
 
-	auto Scene::getEntities(const char& tag) -> std::vector<Entity*>
+	void Scene::_registerEntity(Entity* entity)
 	{
-		std::vector<Entity*> entities;
-		for (const auto& entity : _entities)
+		uint32_t index;
+		if (!_freeSlots.empty())
 		{
-			if (entity->getTag() == tag)
-			{
-				entities.push_back(entity.get());
-			}
+			index = _freeSlots.back();
+			_freeSlots.pop_back();
 		}
-		return entities;
+		else
+		{
+			index = (uint32_t)_slots.size();
+			_slots.emplace_back();
+		}
+
+		_slots[index].entity = entity;
+		entity->_handle = {index, _slots[index].generation};
+
+		_byID[entity->_entityID] = entity;
+		_indexName(entity);
+		_indexTag(entity);
+		_hierarchy.invalidate();
 	}
 
-	auto Scene::removeEntity(Entity* entity) -> void
+	void Scene::_unregisterEntity(Entity* entity)
 	{
-		for (auto it = _entities.begin(); it != _entities.end(); ++it)
+		if (!isValid(entity->_handle))
 		{
-			if ((*it).get() == entity)
-			{
-				(*it)->setActive(false);
-				_entities.erase(it);
-				break;
-			}
+			return;
 		}
+
+		auto& slot = _slots[entity->_handle.index];
+		slot.entity = nullptr;
+		slot.generation = slot.generation + 1 == 0 ? 1 : slot.generation + 1;
+		_freeSlots.push_back(entity->_handle.index);
+		entity->_handle = {};
+
+		_byID.erase(entity->_entityID);
+		_unindexName(entity);
+		_unindexTag(entity);
+		_hierarchy.invalidate();
 	}
 
-	auto Scene::removeEntity(unsigned int id) -> void
+	void Scene::_renameEntity(Entity* entity, const std::string& name)
+	{
+		_unindexName(entity);
+		entity->_entityName = name;
+		_indexName(entity);
+	}
+
+	void Scene::_retagEntity(Entity* entity, unsigned char tag)
+	{
+		_unindexTag(entity);
+		entity->_entityTag = tag;
+		_indexTag(entity);
+	}
+
+	void Scene::_indexName(Entity* entity)
+	{
+		auto& entities = _byName[entity->_entityName];
+		entity->_nameSlot = (uint32_t)entities.size();
+		entities.push_back(entity);
+	}
+
+	void Scene::_unindexName(Entity* entity)
 	{
-		for (auto it = _entities.begin(); it != _entities.end(); ++it)
+		auto it = _byName.find(entity->_entityName);
+		if (it == _byName.end())
 		{
-			if ((*it)->getID() == id)
-			{
-				(*it)->setActive(false);
-				_entities.erase(it);
-				break;
-			}
+			return;
+		}
+
+		// swap and pop, every entity remembers where it sits so this doesn't search
+		auto& entities = it->second;
+		entities[entity->_nameSlot] = entities.back();
+		entities[entity->_nameSlot]->_nameSlot = entity->_nameSlot;
+		entities.pop_back();
+
+		if (entities.empty())
+		{
+			_byName.erase(it);
 		}
 	}
 
-	auto Scene::removeEntity(const std::string& name) -> void
+	void Scene::_indexTag(Entity* entity)
+	{
+		auto& entities = _byTag[entity->_entityTag];
+		entity->_tagSlot = (uint32_t)entities.size();
+		entities.push_back(entity);
+	}
+
+	void Scene::_unindexTag(Entity* entity)
 	{
-		for (auto it = _entities.begin(); it != _entities.end(); ++it)
+		auto it = _byTag.find(entity->_entityTag);
+		if (it == _byTag.end())
 		{
-			if ((*it)->getName() == name)
-			{
-				(*it)->setActive(false);
-				_entities.erase(it);
-				break;
-			}
+			return;
 		}
+
+		auto& entities = it->second;
+		entities[entity->_tagSlot] = entities.back();
+		entities[entity->_tagSlot]->_tagSlot = entity->_tagSlot;
+		entities.pop_back();
 	}
 
-	auto Scene::removeEntities(const char& tag) -> void
+	auto Scene::_findChild(const Entity* parent, const std::string& name) -> Entity*
 	{
-		for (auto it = _entities.begin(); it != _entities.end();)
+		auto it = _byName.find(name);
+		if (it == _byName.end())
+		{
+			return nullptr;
+		}
+
+		// lots of things called "Entity" and only a few children, asking them is faster
+		if (it->second.size() > parent->_children.size())
 		{
-			if ((*it)->getTag() == tag)
+			for (const auto& child : parent->_children)
 			{
-				(*it)->setActive(false);
-				it = _entities.erase(it);
+				if (child->_entityName == name)
+				{
+					return child.get();
+				}
 			}
-			else
+			return nullptr;
+		}
+
+		for (auto* entity : it->second)
+		{
+			if (entity->_parent == parent)
 			{
-				++it;
+				return entity;
 			}
 		}
+		return nullptr;
 	}
 
 	void Scene::tick()
@@ -114,6 +235,12 @@ namespace core
 		{
 			entity->tick();
 		}
+
+		// after everything had its chance to move, so the snapshot gets this tick's
+		_hierarchy.update(_entities);
+
+		// transforms spawned as data, entities keep theirs as a member
+		_world.each<Transform>([](Transform& transform) { transform.update(); });
 	}
 
 	void Scene::render()
@@ -127,7 +254,7 @@ namespace core
 	auto Scene::addEntity(std::string name, char tag) -> Entity*
 	{
 		auto* entity = new Entity(std::move(name), tag);
-		entity->_scene = this;
+		entity->_setScene(this);
 		_entities.push_back(std::unique_ptr<Entity>(entity));
 		return entity;
 	}
@@ -169,6 +296,7 @@ namespace core
 
 	void Scene::addEntity(Entity* entity)
 	{
+		entity->_setScene(this);
 		_entities.push_back(std::unique_ptr<Entity>(entity));
 	}
 
@@ -1,19 +1,124 @@
 #include "core/TickThread.h"
 #include "core/Application.h"
 #include "core/Scene.h"
+#include "graphics/RenderSnapshot.h"
+#include "input/Input.h"
+#include "platform/CpuTopology.h"
+#include "platform/EventPump.h"
+#include <algorithm>
+#include <thread>
 
 namespace core
 {
-    float lastTime;
+	namespace
+	{
+		auto now() -> int64_t
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+					   std::chrono::steady_clock::now().time_since_epoch())
+				.count();
+		}
+	}
 
 	void TickThread::init()
 	{
+		platform::CpuTopology::applyToCurrentThread(platform::ThreadRole::Tick);
         Scene::currentScene->start();
+
+		_previous = now();
+		_accumulator = 0;
+		lastTickTime = _previous;
 	}
 
 	void TickThread::update()
 	{
-		Scene::currentScene->tick();
+		int64_t fixedStep = step.load(std::memory_order_relaxed);
+		if (fixedStep == 0)
+		{
+			platform::EventPump::consume(inputEvents);
+			Input::advance(inputEvents);
+			Scene::currentScene->tick();
+			lastTickTime.store(now(), std::memory_order_relaxed);
+			tickCount.fetch_add(1, std::memory_order_relaxed);
+			graphics::RenderSnapshots::extract(Scene::currentScene, getTickCount());
+			return;
+		}
+
+		int64_t current = now();
+		_accumulator += current - _previous;
+		_previous = current;
+
+		// too far behind to ever catch up, drop the backlog instead of spiralling
+		int64_t maxBacklog = fixedStep * maxCatchUpSteps.load(std::memory_order_relaxed);
+		if (_accumulator > maxBacklog)
+		{
+			droppedTime.fetch_add(_accumulator - maxBacklog, std::memory_order_relaxed);
+			_accumulator = maxBacklog;
+		}
+
+		bool ticked = false;
+		int64_t steps = _accumulator / fixedStep;
+		while (_accumulator >= fixedStep)
+		{
+			// the last snapshot is behind by more than a step now, the renderer blends
+			// from where things were right before the final one
+			if (ticked && steps == 1)
+			{
+				graphics::RenderSnapshots::capturePrevious(Scene::currentScene);
+			}
+
+			// only pick input up when there's a tick to see it, otherwise it'd get lost
+			if (!ticked)
+			{
+				platform::EventPump::consume(inputEvents);
+			}
+			else
+			{
+				inputEvents.clear();
+			}
+
+			// still advanced with nothing, so "went down" only lasts the one tick
+			Input::advance(inputEvents);
+			Scene::currentScene->tick();
+			_accumulator -= fixedStep;
+			tickCount.fetch_add(1, std::memory_order_relaxed);
+			ticked = true;
+			steps--;
+		}
+
+		// only the state after the last step matters to the renderer
+		if (ticked)
+		{
+			graphics::RenderSnapshots::extract(Scene::currentScene, getTickCount());
+		}
+
+		// the leftover is how far into the next step real time already is
+		lastTickTime.store(current - _accumulator, std::memory_order_release);
+
+		waitUntil(current - _accumulator + fixedStep);
+	}
+
+	void TickThread::waitUntil(int64_t deadline)
+	{
+		int64_t window = spinWindow.load(std::memory_order_relaxed);
+
+		// sleep in bounded chunks so terminate() doesn't have to wait out a slow rate
+		while (running.load(std::memory_order_relaxed))
+		{
+			int64_t remaining = deadline - now();
+			if (remaining <= window)
+			{
+				break;
+			}
+
+			std::this_thread::sleep_for(
+				std::chrono::nanoseconds(std::min<int64_t>(remaining - window, 50000000)));
+		}
+
+		while (now() < deadline && running.load(std::memory_order_relaxed))
+		{
+			std::this_thread::yield();
+		}
 	}
 
 	void TickThread::shutdown()
@@ -21,4 +126,44 @@ namespace core
 		Scene::currentScene->clear();
         delete Scene::currentScene;
 	}
-}
\ No newline at end of file
+
+	void TickThread::setTickRate(double hz)
+	{
+		step = hz > 0 ? (int64_t)(1e9 / hz) : 0;
+	}
+
+	auto TickThread::getTickRate() -> double
+	{
+		int64_t fixedStep = step.load(std::memory_order_relaxed);
+		return fixedStep > 0 ? 1e9 / (double)fixedStep : 0;
+	}
+
+	auto TickThread::getFixedDelta() -> double
+	{
+		return (double)step.load(std::memory_order_relaxed) * 1e-9;
+	}
+
+	void TickThread::setMaxCatchUpSteps(uint32_t steps)
+	{
+		maxCatchUpSteps = std::max(steps, 1U);
+	}
+
+	void TickThread::setSpinWindow(std::chrono::microseconds window)
+	{
+		spinWindow = std::chrono::duration_cast<std::chrono::nanoseconds>(window).count();
+	}
+
+	auto TickThread::getAlpha() -> float
+	{
+		int64_t fixedStep = step.load(std::memory_order_relaxed);
+		if (fixedStep == 0)
+		{
+			return 1.0F;
+		}
+
+		// worked out at call time so the renderer gets the alpha for when it draws,
+		// not for when the last tick happened to finish
+		int64_t elapsed = now() - lastTickTime.load(std::memory_order_acquire);
+		return std::clamp((float)elapsed / (float)fixedStep, 0.0F, 1.0F);
+	}
+}
@@ -2,6 +2,7 @@
 #include "core/Entity.h"
 #include "utils/math/Matrix4.h"
 #include "utils/math/Quaternion.h"
+#include "utils/math/TransformBatch.h"
 
 namespace core
 {
@@ -72,7 +73,7 @@ namespace core
 
 	void Transform::setPosition(const math::Vector3& position)
 	{
-		if (Entity* parent = _entity->getParent())
+		if (Entity* parent = _getParent())
 		{
 			math::Matrix4 parentWorld = parent->transform._worldMatrix;
 			_localPos = parentWorld.inverse() * position;
@@ -86,7 +87,7 @@ namespace core
 
 	void Transform::setRotation(const math::Quaternion& rotation)
 	{
-		if (Entity* parent = _entity->getParent())
+		if (Entity* parent = _getParent())
 		{
 			math::Quaternion parentRot = parent->transform.getRotation();
 			_localRot = parentRot.inverse() * rotation;
@@ -160,19 +161,18 @@ namespace core
 		return _worldMatrix.inverse() * point;
 	}
 
+	auto Transform::_getParent() const -> Entity*
+	{
+		// transforms stored straight in an ecs::World don't belong to any entity
+		return _entity != nullptr ? _entity->getParent() : nullptr;
+	}
+
 	// Dirty handling
 	void Transform::_markDirty()
 	{
-		if (_dirty)
-		{
-			return;
-		}
+		// children don't need telling, the scene's hierarchy pass recomputes everything
+		// under a transform that got recomputed
 		_dirty = true;
-		// Propagate to children
-		for (Entity* child : _entity->getChildren())
-		{
-			child->transform._markDirty();
-		}
 	}
 
 	void Transform::_recomputeWorldMatrix()
@@ -182,7 +182,17 @@ namespace core
 			return;
 		}
 
-		_worldMatrix = getParentWorldMatrix() * getLocalMatrix();
+		_applyParent(getParentWorldMatrix());
+	}
+
+	void Transform::_applyParent(const math::Matrix4& parentWorld)
+	{
+		_setWorld(parentWorld * getLocalMatrix());
+	}
+
+	void Transform::_setWorld(const math::Matrix4& world)
+	{
+		_worldMatrix = world;
 		_cachedWorldPos = math::Vector3(_worldMatrix.data[0][3], _worldMatrix.data[1][3],
 										_worldMatrix.data[2][3]);
 		_cachedWorldRot = _worldMatrix.getRotation();
@@ -191,18 +201,14 @@ namespace core
 
 	auto Transform::getLocalMatrix() -> math::Matrix4
 	{
-		auto translation = math::Matrix4::translation(_localPos);
-		auto rotation = math::Matrix4::rotation(_localRot);
-		auto scaling = math::Matrix4::scaling(_localScale);
-
-		return math::Matrix4::multiply({translation, rotation, scaling});
+		return math::composeTRS(_localPos, _localRot, _localScale);
 	}
 
 	auto Transform::getParentWorldMatrix() -> math::Matrix4
 	{
-		if (!_entity->isOrphan())
+		if (Entity* parent = _getParent())
 		{
-			return _entity->getParent()->transform.getWorldMatrix();
+			return parent->transform.getWorldMatrix();
 		}
 		return {};
 	}
@@ -230,7 +236,7 @@ namespace core
 
 	void Transform::setEulerAngles(const math::Vector3& rotation)
 	{
-		if (Entity* parent = _entity->getParent())
+		if (Entity* parent = _getParent())
 		{
 			math::Quaternion parentRot = parent->transform.getRotation();
 			_localRot = parentRot.inverse() * math::Quaternion::fromEuler(rotation);
@@ -0,0 +1,135 @@
+#include "core/TransformHierarchy.h"
+#include "core/Entity.h"
+#include "core/Transform.h"
+#include "core/jobs/Parallel.h"
+#include "utils/math/TransformBatch.h"
+
+namespace core
+{
+	void TransformHierarchy::update(const std::vector<std::unique_ptr<Entity>>& roots)
+	{
+		if (_stale)
+		{
+			_rebuild(roots);
+		}
+
+		for (size_t level = 0; level + 1 < _levels.size(); level++)
+		{
+			size_t begin = _levels[level];
+			size_t end = _levels[level + 1];
+
+			if (end - begin < ParallelThreshold)
+			{
+				_updateRange(begin, end);
+				continue;
+			}
+
+			// everything in a level only reads the level above, which is done by now
+			jobs::parallelFor(begin, end, ParallelGrain,
+							  [this](size_t first, size_t last) { _updateRange(first, last); });
+		}
+	}
+
+	void TransformHierarchy::_rebuild(const std::vector<std::unique_ptr<Entity>>& roots)
+	{
+		_transforms.clear();
+		_parents.clear();
+		_entities.clear();
+		_levels.clear();
+
+		for (const auto& root : roots)
+		{
+			_entities.push_back(root.get());
+			_transforms.push_back(&root->transform);
+			_parents.push_back(NoParent);
+		}
+
+		// breadth first, each level's children get appended right after it
+		size_t begin = 0;
+		while (begin < _entities.size())
+		{
+			size_t end = _entities.size();
+			_levels.push_back(begin);
+
+			for (size_t i = begin; i < end; i++)
+			{
+				for (const auto& child : _entities[i]->_children)
+				{
+					_entities.push_back(child.get());
+					_transforms.push_back(&child->transform);
+					_parents.push_back((uint32_t)i);
+				}
+			}
+
+			begin = end;
+		}
+		_levels.push_back(_entities.size());
+
+		// nothing needs recomputing just because the indices moved, reparented
+		// entities are already dirty and new ones start out that way
+		_changed.assign(_transforms.size(), 0);
+
+		_stale = false;
+	}
+
+	void TransformHierarchy::_updateRange(size_t begin, size_t end)
+	{
+		// whatever needs recomputing gets gathered into streams a block at a time and
+		// goes through the batched kernel together
+		float streams[10][BatchSize];
+		const math::Matrix4* parents[BatchSize];
+		uint32_t nodes[BatchSize];
+		math::Matrix4 worlds[BatchSize];
+
+		math::TransformStreams local{streams[0], streams[1], streams[2], streams[3], streams[4],
+									 streams[5], streams[6], streams[7], streams[8], streams[9]};
+		size_t count = 0;
+
+		auto flush = [&]()
+		{
+			math::composeWorldMatrices(local, parents, worlds, count);
+			for (size_t i = 0; i < count; i++)
+			{
+				_transforms[nodes[i]]->_setWorld(worlds[i]);
+			}
+			count = 0;
+		};
+
+		for (size_t i = begin; i < end; i++)
+		{
+			auto* transform = _transforms[i];
+			uint32_t parent = _parents[i];
+			bool parentChanged = parent != NoParent && _changed[parent] != 0;
+
+			if (!transform->_dirty && !parentChanged)
+			{
+				_changed[i] = 0;
+				continue;
+			}
+
+			streams[0][count] = transform->_localPos.x;
+			streams[1][count] = transform->_localPos.y;
+			streams[2][count] = transform->_localPos.z;
+			streams[3][count] = transform->_localRot.x;
+			streams[4][count] = transform->_localRot.y;
+			streams[5][count] = transform->_localRot.z;
+			streams[6][count] = transform->_localRot.w;
+			streams[7][count] = transform->_localScale.x;
+			streams[8][count] = transform->_localScale.y;
+			streams[9][count] = transform->_localScale.z;
+			parents[count] = parent != NoParent ? &_transforms[parent]->_worldMatrix : nullptr;
+			nodes[count] = (uint32_t)i;
+			_changed[i] = 1;
+
+			if (++count == BatchSize)
+			{
+				flush();
+			}
+		}
+
+		if (count != 0)
+		{
+			flush();
+		}
+	}
+}
@@ -0,0 +1,149 @@
+#include "core/ecs/Archetype.h"
+#include "core/log.h"
+#include <algorithm>
+#include <new>
+
+namespace core::ecs
+{
+	namespace
+	{
+		constexpr std::align_val_t ChunkAlignment{MaxComponentAlignment};
+
+		auto alignUp(size_t value, size_t alignment) -> size_t
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+	Archetype::Archetype(const Signature& signature) : _signature(signature)
+	{
+		_columnOf.fill(NoColumn);
+
+		for (size_t type = 0; type < MaxComponentTypes; type++)
+		{
+			if (signature.test(type))
+			{
+				Column column;
+				column.type = (ComponentTypeID)type;
+				column.info = &getComponentInfo(column.type);
+				_columns.push_back(column);
+			}
+		}
+
+		// most aligned first, so there's as little padding between the arrays as it gets
+		std::stable_sort(_columns.begin(), _columns.end(), [](const Column& a, const Column& b)
+						 { return a.info->alignment > b.info->alignment; });
+
+		size_t rowBytes = sizeof(EntityID);
+		for (const auto& column : _columns)
+		{
+			rowBytes += column.info->size;
+		}
+
+		auto layout = [this](uint32_t capacity) -> size_t
+		{
+			size_t offset = (size_t)capacity * sizeof(EntityID);
+			for (auto& column : _columns)
+			{
+				offset = alignUp(offset, column.info->alignment);
+				column.offset = offset;
+				offset += (size_t)capacity * column.info->size;
+			}
+			return offset;
+		};
+
+		_capacity = (uint32_t)(ChunkSize / rowBytes);
+		while (_capacity > 0 && layout(_capacity) > ChunkSize)
+		{
+			_capacity--;
+		}
+
+		if (_capacity == 0)
+		{
+			// one row doesn't even fit, these get a chunk each (and a bigger one)
+			_capacity = 1;
+			_chunkBytes = alignUp(layout(1), MaxComponentAlignment);
+			log_warn("archetype row is %zu bytes, more than a whole chunk", rowBytes);
+		}
+		else
+		{
+			layout(_capacity);
+		}
+
+		for (size_t i = 0; i < _columns.size(); i++)
+		{
+			_columnOf[_columns[i].type] = (uint8_t)i;
+		}
+	}
+
+	Archetype::~Archetype()
+	{
+		_clear();
+	}
+
+	auto Archetype::_allocate(EntityID entity) -> uint32_t
+	{
+		auto row = (uint32_t)_count;
+		if (row / _capacity == _chunks.size())
+		{
+			_chunks.push_back(static_cast<std::byte*>(::operator new(_chunkBytes, ChunkAlignment)));
+		}
+
+		getEntities(row / _capacity)[row % _capacity] = entity;
+		_count++;
+		return row;
+	}
+
+	auto Archetype::_removeRow(uint32_t row) -> EntityID
+	{
+		auto last = (uint32_t)(_count - 1);
+		EntityID moved;
+
+		if (row != last)
+		{
+			for (const auto& column : _columns)
+			{
+				moveComponent(*column.info, getComponent(row, column.type),
+							  getComponent(last, column.type));
+			}
+
+			moved = getEntity(last);
+			getEntities(row / _capacity)[row % _capacity] = moved;
+		}
+
+		_count--;
+
+		// keep one empty chunk around, so an entity going back and forth over the
+		// edge doesn't allocate every time
+		while (_chunks.size() > getChunkCount() + 1)
+		{
+			::operator delete(_chunks.back(), ChunkAlignment);
+			_chunks.pop_back();
+		}
+
+		return moved;
+	}
+
+	void Archetype::_destroyRow(uint32_t row)
+	{
+		for (const auto& column : _columns)
+		{
+			destroyComponent(*column.info, getComponent(row, column.type));
+		}
+	}
+
+	void Archetype::_clear()
+	{
+		for (auto row = (uint32_t)_count; row > 0; row--)
+		{
+			_destroyRow(row - 1);
+		}
+		_count = 0;
+
+		for (auto* chunk : _chunks)
+		{
+			::operator delete(chunk, ChunkAlignment);
+		}
+		_chunks.clear();
+	}
+}
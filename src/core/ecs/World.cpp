@@ -0,0 +1,244 @@
+#include "core/ecs/World.h"
+#include "core/log.h"
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+namespace core::ecs
+{
+	namespace
+	{
+		// fixed size so lookups never race a registration moving things around
+		ComponentInfo componentInfos[MaxComponentTypes];
+		std::atomic<size_t> componentCount{0};
+		std::mutex registerLock;
+	}
+
+	auto internals::registerComponentType(const ComponentInfo& info) -> ComponentTypeID
+	{
+		std::lock_guard<std::mutex> lock(registerLock);
+
+		size_t id = componentCount.load(std::memory_order_relaxed);
+		if (id == MaxComponentTypes)
+		{
+			log_fatal("more than %zu component types registered", MaxComponentTypes);
+			std::abort();
+		}
+
+		componentInfos[id] = info;
+		componentCount.store(id + 1, std::memory_order_release);
+		return (ComponentTypeID)id;
+	}
+
+	auto getComponentInfo(ComponentTypeID type) -> const ComponentInfo&
+	{
+		return componentInfos[type];
+	}
+
+	auto getComponentTypeCount() -> size_t
+	{
+		return componentCount.load(std::memory_order_acquire);
+	}
+
+	World::World()
+	{
+		_empty = _getArchetype({});
+	}
+
+	World::~World()
+	{
+		clear();
+	}
+
+	auto World::create() -> EntityID
+	{
+		if (!_canChange())
+		{
+			return {};
+		}
+
+		auto entity = _newID();
+		auto& record = _records[entity.index];
+		record.archetype = _empty;
+		record.row = _empty->_allocate(entity);
+		return entity;
+	}
+
+	void World::destroy(EntityID entity)
+	{
+		if (!isAlive(entity) || !_canChange())
+		{
+			return;
+		}
+
+		auto& record = _records[entity.index];
+		record.archetype->_destroyRow(record.row);
+
+		auto moved = record.archetype->_removeRow(record.row);
+		if (moved.isValid())
+		{
+			_records[moved.index].row = record.row;
+		}
+
+		record.archetype = nullptr;
+		record.generation++;
+		if (record.generation == 0)
+		{
+			record.generation = 1;
+		}
+
+		_freeList.push_back(entity.index);
+		_alive--;
+	}
+
+	void World::clear()
+	{
+		if (!_canChange())
+		{
+			return;
+		}
+
+		// archetypes and queries stay, whatever made them is likely to come back
+		for (auto* archetype : _archetypeList)
+		{
+			archetype->_clear();
+		}
+
+		_freeList.clear();
+		for (uint32_t i = 0; i < _records.size(); i++)
+		{
+			auto& record = _records[i];
+			if (record.archetype != nullptr)
+			{
+				record.archetype = nullptr;
+				record.generation = record.generation + 1 == 0 ? 1 : record.generation + 1;
+			}
+			_freeList.push_back(i);
+		}
+
+		_alive = 0;
+	}
+
+	auto World::_newID() -> EntityID
+	{
+		uint32_t index;
+		if (!_freeList.empty())
+		{
+			index = _freeList.back();
+			_freeList.pop_back();
+		}
+		else
+		{
+			index = (uint32_t)_records.size();
+			_records.emplace_back();
+		}
+
+		_alive++;
+		return {index, _records[index].generation};
+	}
+
+	auto World::_canChange() const -> bool
+	{
+		if (_iterating != 0)
+		{
+			log_error("can't change entities in the middle of an each()");
+			return false;
+		}
+		return true;
+	}
+
+	auto World::_getArchetype(const Signature& signature) -> Archetype*
+	{
+		auto& archetype = _archetypes[signature];
+		if (archetype == nullptr)
+		{
+			archetype = std::make_unique<Archetype>(signature);
+			_archetypeList.push_back(archetype.get());
+		}
+		return archetype.get();
+	}
+
+	auto World::_match(const Signature& signature) -> const std::vector<Archetype*>&
+	{
+		auto& query = _queries[signature];
+		for (; query.checked < _archetypeList.size(); query.checked++)
+		{
+			auto* archetype = _archetypeList[query.checked];
+			if ((archetype->getSignature() & signature) == signature)
+			{
+				query.archetypes.push_back(archetype);
+			}
+		}
+		return query.archetypes;
+	}
+
+	void World::_move(EntityID entity, Archetype* to)
+	{
+		auto& record = _records[entity.index];
+		auto* from = record.archetype;
+		auto row = to->_allocate(entity);
+
+		for (const auto& column : from->_columns)
+		{
+			void* source = from->getComponent(record.row, column.type);
+			if (to->has(column.type))
+			{
+				moveComponent(*column.info, to->getComponent(row, column.type), source);
+			}
+			else
+			{
+				destroyComponent(*column.info, source);
+			}
+		}
+
+		auto moved = from->_removeRow(record.row);
+		if (moved.isValid())
+		{
+			_records[moved.index].row = record.row;
+		}
+
+		record.archetype = to;
+		record.row = row;
+	}
+
+	auto World::_addComponent(EntityID entity, ComponentTypeID type) -> void*
+	{
+		if (!_canChange())
+		{
+			return nullptr;
+		}
+
+		auto* from = _records[entity.index].archetype;
+		auto& to = from->_addEdges[type];
+		if (to == nullptr)
+		{
+			auto signature = from->getSignature();
+			to = _getArchetype(signature.set(type));
+			to->_removeEdges[type] = from;
+		}
+
+		_move(entity, to);
+
+		const auto& record = _records[entity.index];
+		return to->getComponent(record.row, type);
+	}
+
+	void World::_removeComponent(EntityID entity, ComponentTypeID type)
+	{
+		if (!_canChange())
+		{
+			return;
+		}
+
+		auto* from = _records[entity.index].archetype;
+		auto& to = from->_removeEdges[type];
+		if (to == nullptr)
+		{
+			auto signature = from->getSignature();
+			to = _getArchetype(signature.reset(type));
+			to->_addEdges[type] = from;
+		}
+
+		_move(entity, to);
+	}
+}
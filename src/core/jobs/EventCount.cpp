@@ -0,0 +1,73 @@
+#include "core/jobs/EventCount.h"
+#include <climits>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace core::jobs
+{
+	void EventCount::commitWait(Key key)
+	{
+#ifdef __linux__
+		// the kernel checks the value again before sleeping, so an epoch bump between
+		// prepareWait and here makes this return right away. spurious wakeups just
+		// loop back
+		while (_epoch.load(std::memory_order_acquire) == key)
+		{
+			syscall(SYS_futex, (uint32_t*)&_epoch, FUTEX_WAIT_PRIVATE, key, nullptr, nullptr,
+					0);
+		}
+#else
+		std::unique_lock<std::mutex> lock(_mutex);
+		_condition.wait(lock, [&]() { return _epoch.load(std::memory_order_acquire) != key; });
+#endif
+
+		_waiters.fetch_sub(1, std::memory_order_seq_cst);
+	}
+
+	void EventCount::notify(uint32_t count)
+	{
+		// pairs with the increment in prepareWait, either the waiter sees whatever we
+		// published before this or we see the waiter
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (_waiters.load(std::memory_order_seq_cst) == 0)
+		{
+			return;
+		}
+
+		_wake(count);
+	}
+
+	void EventCount::notifyAll()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (_waiters.load(std::memory_order_seq_cst) == 0)
+		{
+			return;
+		}
+
+		_wake(INT_MAX);
+	}
+
+	void EventCount::_wake(uint32_t count)
+	{
+		_epoch.fetch_add(1, std::memory_order_seq_cst);
+
+#ifdef __linux__
+		syscall(SYS_futex, (uint32_t*)&_epoch, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (count == 1)
+		{
+			_condition.notify_one();
+		}
+		else
+		{
+			_condition.notify_all();
+		}
+#endif
+	}
+}
\ No newline at end of file
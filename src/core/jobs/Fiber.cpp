@@ -0,0 +1,151 @@
+#include "core/jobs/Fiber.h"
+#include "core/jobs/Job.h"
+#include "core/log.h"
+#include <cstdint>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace core::jobs
+{
+	Fiber::Fiber(size_t stackSize)
+	{
+		// one extra page at the bottom with no access, so running off the end of the
+		// stack crashes right away instead of scribbling over someone else's
+		size_t pageSize = sysconf(_SC_PAGESIZE);
+		this->stackSize = ((stackSize + pageSize - 1) / pageSize + 1) * pageSize;
+
+		void* memory = mmap(nullptr, this->stackSize, PROT_READ | PROT_WRITE,
+							MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+		if (memory == MAP_FAILED)
+		{
+			log_error("failed to allocate a %d byte fiber stack", this->stackSize);
+			return;
+		}
+
+		mprotect(memory, pageSize, PROT_NONE);
+		stack = memory;
+
+		getcontext(&context);
+		context.uc_stack.ss_sp = (char*)stack + pageSize;
+		context.uc_stack.ss_size = this->stackSize - pageSize;
+		context.uc_link = nullptr;
+
+		// makecontext only passes ints along
+		auto pointer = (uintptr_t)this;
+		makecontext(&context, (void (*)())&Fiber::entry, 2, (unsigned int)pointer,
+					(unsigned int)(pointer >> 32));
+	}
+
+	Fiber::~Fiber()
+	{
+		if (stack != nullptr)
+		{
+			munmap(stack, stackSize);
+		}
+	}
+
+	__attribute__((noinline)) auto Fiber::current() -> Fiber*
+	{
+		return currentFiber;
+	}
+
+	void Fiber::entry(unsigned int low, unsigned int high)
+	{
+		auto* fiber = (Fiber*)(((uintptr_t)high << 32) | (uintptr_t)low);
+
+		// never returns, finishing a job just hands control back until the next one
+		while (true)
+		{
+			fiber->job->execute();
+			fiber->suspend(FiberStatus::Finished);
+		}
+	}
+
+	void Fiber::resume()
+	{
+		// the context lives in a thread local, so grab its address on this thread
+		caller = &threadContext;
+		status = FiberStatus::Running;
+		currentFiber = this;
+
+		swapcontext(caller, &context);
+
+		currentFiber = nullptr;
+	}
+
+	void Fiber::suspend(FiberStatus status)
+	{
+		this->status = status;
+		swapcontext(&context, caller);
+	}
+
+	void FiberPool::initialize(size_t count, size_t stackSize)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		fiberStackSize = stackSize;
+		maxCount = std::max(count, MaxFibers);
+
+		fibers.reserve(count);
+		freeFibers.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			auto fiber = std::make_unique<Fiber>(stackSize);
+			if (!fiber->isValid())
+			{
+				break;
+			}
+
+			freeFibers.push_back(fiber.get());
+			fibers.push_back(std::move(fiber));
+		}
+
+		log_info("created %d fibers with %d kb stacks", fibers.size(), stackSize / 1024);
+	}
+
+	void FiberPool::shutdown()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (fibers.size() != freeFibers.size())
+		{
+			log_warn("%d jobs were still parked on fibers at shutdown",
+					 fibers.size() - freeFibers.size());
+		}
+
+		freeFibers.clear();
+		fibers.clear();
+	}
+
+	auto FiberPool::acquire() -> Fiber*
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (!freeFibers.empty())
+		{
+			auto* fiber = freeFibers.back();
+			freeFibers.pop_back();
+			return fiber;
+		}
+
+		// everything is parked, make more as long as we're under the limit
+		if (fibers.size() >= maxCount)
+		{
+			return nullptr;
+		}
+
+		auto fiber = std::make_unique<Fiber>(fiberStackSize);
+		if (!fiber->isValid())
+		{
+			return nullptr;
+		}
+
+		fibers.push_back(std::move(fiber));
+		return fibers.back().get();
+	}
+
+	void FiberPool::release(Fiber* fiber)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		freeFibers.push_back(fiber);
+	}
+}
\ No newline at end of file
@@ -1,51 +1,175 @@
 #include "core/jobs/FrameMemoryPool.h"
 #include "core/log.h"
 #include <algorithm>
-#include <cstring>
 
 namespace core::jobs
 {
+	namespace
+	{
+		auto alignUp(uintptr_t value, size_t alignment) -> uintptr_t
+		{
+			return (value + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		}
+	}
+
+	thread_local FrameMemoryPool::Slab FrameMemoryPool::slabs[SlabSlots];
+
 	FrameMemoryPool::FrameMemoryPool(size_t initialSize)
-		: _offset(0), _size((initialSize + 4095) & ~4095)
+		: _offset(0), _size((initialSize + 4095) & ~4095), _epoch(nextEpoch++),
+		  _slabSlot(_takeSlabSlot())
 	{
 		_memory = std::make_unique<uint8_t[]>(_size);
 		_stats.currentSize = _size;
 	}
 
+	FrameMemoryPool::~FrameMemoryPool()
+	{
+		// whatever threads still have in the slot is from our epoch, nobody else
+		// matches it so the next pool starts clean
+		if (_ownsSlabSlot)
+		{
+			slabSlotsTaken.fetch_and(~(1U << _slabSlot), std::memory_order_release);
+		}
+	}
+
+	auto FrameMemoryPool::_takeSlabSlot() -> size_t
+	{
+		uint32_t taken = slabSlotsTaken.load(std::memory_order_relaxed);
+		while (true)
+		{
+			size_t slot = 0;
+			while (slot < SlabSlots && (taken & (1U << slot)) != 0)
+			{
+				slot++;
+			}
+
+			if (slot == SlabSlots)
+			{
+				log_warn("more than %zu frame memory pools alive, some of them share slabs",
+						 SlabSlots);
+				return _epoch % SlabSlots;
+			}
+
+			if (slabSlotsTaken.compare_exchange_weak(taken, taken | (1U << slot),
+													 std::memory_order_acquire,
+													 std::memory_order_relaxed))
+			{
+				_ownsSlabSlot = true;
+				return slot;
+			}
+		}
+	}
+
 	auto FrameMemoryPool::allocate(size_t size, size_t alignment) -> void*
 	{
-		size_t currentOffset = _offset.load(std::memory_order_relaxed);
-		size_t alignedOffset = (currentOffset + alignment - 1) & ~(alignment - 1);
-		size_t newOffset = alignedOffset + size;
+		auto& current = slabs[_slabSlot];
+		if (current.epoch != _epoch)
+		{
+			_join(current);
+		}
 
-		if (newOffset > _size)
+		auto& stats = *current.stats;
+		if (&stats != &_threadStats[StatSlots])
 		{
-			return nullptr;
+			stats.allocations.store(stats.allocations.load(std::memory_order_relaxed) + 1,
+									std::memory_order_relaxed);
+			stats.bytes.store(stats.bytes.load(std::memory_order_relaxed) + size,
+							  std::memory_order_relaxed);
+		}
+		else
+		{
+			stats.allocations.fetch_add(1, std::memory_order_relaxed);
+			stats.bytes.fetch_add(size, std::memory_order_relaxed);
+		}
+
+		// big ones would waste most of a slab, they go straight to the shared buffer
+		if (size > SlabSize / 4 || alignment > SlabSize / 4)
+		{
+			void* memory = _claim(size, alignment);
+			return memory != nullptr ? memory : _allocateOverflow(size, alignment);
+		}
+
+		auto* aligned = (uint8_t*)alignUp((uintptr_t)current.cursor, alignment);
+		if (current.cursor != nullptr && aligned + size <= current.end)
+		{
+			current.cursor = aligned + size;
+			return aligned;
+		}
+
+		// slab is full (or from an older frame), grab a new one. whatever was left in
+		// the old one is wasted, at most SlabSize / 4
+		auto* memory = (uint8_t*)_claim(SlabSize, alignof(std::max_align_t));
+		if (memory == nullptr)
+		{
+			return _allocateOverflow(size, alignment);
 		}
 
-		if (!_offset.compare_exchange_weak(currentOffset, newOffset,
-										   std::memory_order_relaxed))
+		aligned = (uint8_t*)alignUp((uintptr_t)memory, alignment);
+		current.cursor = aligned + size;
+		current.end = memory + SlabSize;
+		return aligned;
+	}
+
+	void FrameMemoryPool::_join(Slab& slab)
+	{
+		size_t slot = _statSlotsUsed.fetch_add(1, std::memory_order_relaxed);
+
+		slab.epoch = _epoch;
+		slab.cursor = nullptr;
+		slab.end = nullptr;
+		slab.stats = &_threadStats[std::min(slot, StatSlots)];
+	}
+
+	auto FrameMemoryPool::_claim(size_t size, size_t alignment) -> void*
+	{
+		// fetch_add can't fail spuriously like a CAS, if it goes past the end the
+		// buffer is simply full until the next reset
+		size_t padded = size + alignment - 1;
+		size_t offset = _offset.fetch_add(padded, std::memory_order_relaxed);
+		if (offset + padded > _size)
 		{
 			return nullptr;
 		}
 
-		// update stats
-		size_t used = newOffset;
-		_stats.usedThisFrame = std::max(_stats.usedThisFrame, used);
-		_stats.peakBytesUsed = std::max(_stats.peakBytesUsed, used);
-		_stats.allocationsThisFrame++;
-		_stats.totalAllocations++;
-		_stats.totalBytesAllocated += size;
+		return (void*)alignUp((uintptr_t)(_memory.get() + offset), alignment);
+	}
+
+	auto FrameMemoryPool::_allocateOverflow(size_t size, size_t alignment) -> void*
+	{
+		auto memory = std::make_unique<uint8_t[]>(size + alignment - 1);
+		auto* aligned = (void*)alignUp((uintptr_t)memory.get(), alignment);
+
+		_overflowBytes.fetch_add(size, std::memory_order_relaxed);
 
-		return _memory.get() + alignedOffset;
+		std::lock_guard<std::mutex> lock(_overflowMutex);
+		_overflow.push_back(std::move(memory));
+		return aligned;
 	}
 
 	void FrameMemoryPool::reset()
 	{
 		_framesSinceLastResize++;
 
-		// track usage
-		size_t used = _offset.exchange(0, std::memory_order_relaxed);
+		// fold what the threads did this frame into the totals
+		for (auto& stats : _threadStats)
+		{
+			_stats.totalAllocations += stats.allocations.exchange(0, std::memory_order_relaxed);
+			_stats.totalBytesAllocated += stats.bytes.exchange(0, std::memory_order_relaxed);
+		}
+		_statSlotsUsed.store(0, std::memory_order_relaxed);
+		_stats.allocationsThisFrame = 0;
+		_stats.overflowAllocations += _overflow.size();
+
+		// track usage, whatever spilled to the heap counts too so we grow past it
+		size_t used = std::min(_offset.exchange(0, std::memory_order_relaxed), _size) +
+					  _overflowBytes.exchange(0, std::memory_order_relaxed);
+		_overflow.clear();
+
+		_stats.peakBytesUsed = std::max(_stats.peakBytesUsed, used);
+
+		// every slab handed out so far is gone
+		_epoch = nextEpoch++;
+
 		_recentUsage.push_back(used);
 		if (_recentUsage.size() > UsageWindow)
 		{
@@ -75,7 +199,7 @@ namespace core::jobs
 			_framesSinceLastResize >= ResizeCooldownFrames)
 		{
             log_trace("frame memory pool wasn't enough, expanding");
-			_resize(_size * 2);
+			_resize(std::max(_size * 2, used));
 			_overuseCount = 0;
 			_framesSinceLastResize = 0;
 			_recentUsage.clear();
@@ -105,14 +229,10 @@ namespace core::jobs
 			return;
 		}
 
+		// only called from reset, so there's nothing in the old buffer worth keeping
 		newSize = (newSize + 4095) & ~4095;
-		auto newMemory = std::make_unique<uint8_t[]>(newSize);
-		size_t used = std::min(_offset.load(std::memory_order_relaxed), newSize);
-		std::memcpy(newMemory.get(), _memory.get(), used);
-
-		_memory = std::move(newMemory);
+		_memory = std::make_unique<uint8_t[]>(newSize);
 		_size = newSize;
-		_offset.store(used, std::memory_order_relaxed);
 
 		_stats.currentSize = _size;
 		_stats.resizesPerformed++;
@@ -120,16 +240,28 @@ namespace core::jobs
 
 	auto FrameMemoryPool::getBytesUsed() const -> size_t
 	{
-		return _offset.load(std::memory_order_relaxed);
+		return std::min(_offset.load(std::memory_order_relaxed), _size) +
+			   _overflowBytes.load(std::memory_order_relaxed);
 	}
 
 	auto FrameMemoryPool::getBytesRemaining() const -> size_t
 	{
-		return _size - _offset.load(std::memory_order_relaxed);
+		return _size - std::min(_offset.load(std::memory_order_relaxed), _size);
 	}
 
-	auto FrameMemoryPool::getStats() const -> const FrameMemoryPool::Stats&
+	auto FrameMemoryPool::getStats() const -> FrameMemoryPool::Stats
 	{
-		return _stats;
+		Stats stats = _stats;
+		for (const auto& thread : _threadStats)
+		{
+			size_t allocations = thread.allocations.load(std::memory_order_relaxed);
+			stats.allocationsThisFrame += allocations;
+			stats.totalAllocations += allocations;
+			stats.totalBytesAllocated += thread.bytes.load(std::memory_order_relaxed);
+		}
+
+		stats.usedThisFrame = getBytesUsed();
+		stats.peakBytesUsed = std::max(stats.peakBytesUsed, stats.usedThisFrame);
+		return stats;
 	}
-}
\ No newline at end of file
+}
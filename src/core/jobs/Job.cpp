@@ -2,6 +2,7 @@
 #include "core/jobs/JobManager.h"
 #include "core/jobs/JobTypes.h"
 #include "core/log.h"
+#include <thread>
 
 namespace core::jobs
 {
@@ -25,64 +26,31 @@ namespace core::jobs
 		catch (...)
 		{
 			state.store(JobState::Failed, std::memory_order_release);
-			log_error("failed to execute job %d", id);
+			log_error("failed to execute job %lu", getId());
 		}
 
-        JobManager::onComplete(id);
+        JobManager::onComplete(this);
+	}
+
+	void Job::lockSuccessors()
+	{
+		// only ever held for a couple of instructions
+		while (successorLock.test_and_set(std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	void Job::unlockSuccessors()
+	{
+		successorLock.clear(std::memory_order_release);
 	}
 
     void Job::waitForDependencies()
     {
         while (refCount != 0)
         {
-            if (auto* worker = JobManager::currentWorkerThread)
-            {
-                worker->yield();
-            }
-            else
-            {
-                std::this_thread::yield();
-            }
+            JobManager::pause();
         }
     }
-
-	void Job::wait()
-    {
-        // failure is still completion
-        while (state != JobState::Completed || state != JobState::Failed)
-        {
-			if (auto* worker = JobManager::currentWorkerThread)
-			{
-				worker->yield();
-			}
-			else
-			{
-				std::this_thread::yield();
-			}
-		}
-    }
-
-	auto Job::wait(std::chrono::milliseconds timeout) -> bool
-    {
-		auto startTime = std::chrono::steady_clock::now();
-
-		while (state != JobState::Completed || state != JobState::Failed)
-		{
-			if (std::chrono::steady_clock::now() - startTime > timeout)
-			{
-				return false;
-			}
-
-			if (auto* worker = JobManager::currentWorkerThread)
-			{
-				worker->yield();
-			}
-			else
-			{
-				std::this_thread::yield();
-			}
-		}
-
-        return true;
-	}
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "core/jobs/JobCounter.h"
+#include "core/jobs/Fiber.h"
+#include "core/jobs/JobManager.h"
+#include <thread>
+
+namespace core::jobs
+{
+	void JobCounter::decrement()
+	{
+		Job* waiters = nullptr;
+
+		_lock();
+		if (_value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			waiters = _waiters;
+			_waiters = nullptr;
+		}
+		_unlock();
+
+		// the counter may be gone by now, only the list we took is safe to use
+		while (waiters != nullptr)
+		{
+			Job* next = waiters->nextWaiter;
+			waiters->nextWaiter = nullptr;
+			JobManager::resumeWaiter(waiters);
+			waiters = next;
+		}
+	}
+
+	void JobCounter::wait() const
+	{
+		if (Fiber::current() != nullptr)
+		{
+			while (!isDone())
+			{
+				JobManager::park(this);
+			}
+
+			return;
+		}
+
+		while (!isDone())
+		{
+			if (!JobManager::help())
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobCounter::_lock() const
+	{
+		while (_locked.exchange(true, std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	void JobCounter::_unlock() const
+	{
+		_locked.store(false, std::memory_order_release);
+	}
+}
\ No newline at end of file
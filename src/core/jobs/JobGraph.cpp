@@ -0,0 +1,139 @@
+#include "core/jobs/JobGraph.h"
+#include "core/jobs/JobManager.h"
+#include "core/jobs/JobPool.h"
+#include "core/log.h"
+
+namespace core::jobs
+{
+	JobGraph::~JobGraph()
+	{
+		if (_submitted || _failed)
+		{
+			// the ones that got turned away are the job system's to drop
+			_counter.wait();
+			return;
+		}
+
+		// nothing outside the graph can point at these, so they can all go at once
+		for (auto& node : _nodes)
+		{
+			if (auto* job = JobManager::getJob(node))
+			{
+				JobPool::release(job);
+			}
+		}
+	}
+
+	auto JobGraph::addNode(Job::WorkFunction work, void* data, JobPriority priority)
+		-> NodeID
+	{
+		if (_submitted || _failed)
+		{
+			log_error("can't add nodes to a job graph that was already submitted");
+			return InvalidNode;
+		}
+
+		auto handle = JobManager::createJob(work, data, priority);
+		if (!handle.isValid())
+		{
+			return InvalidNode;
+		}
+
+		_nodes.push_back(handle);
+		_successors.emplace_back();
+		return _nodes.size() - 1;
+	}
+
+	void JobGraph::addEdge(NodeID from, NodeID to)
+	{
+		if (_submitted || _failed || from >= _nodes.size() || to >= _nodes.size() ||
+			from == to)
+		{
+			log_error("invalid job graph edge (%d -> %d)", from, to);
+			return;
+		}
+
+		JobManager::addDependency(_nodes[to], _nodes[from]);
+		_successors[from].push_back(to);
+	}
+
+	auto JobGraph::submit() -> bool
+	{
+		if (_submitted || _failed)
+		{
+			return false;
+		}
+
+		// dependencies first. a node turned away can only have successors that
+		// weren't submitted yet, so nothing in flight ends up waiting on it
+		std::vector<uint32_t> dependencies(_nodes.size(), 0);
+		for (const auto& successors : _successors)
+		{
+			for (auto to : successors)
+			{
+				dependencies[to]++;
+			}
+		}
+
+		std::vector<NodeID> order;
+		order.reserve(_nodes.size());
+		for (NodeID node = 0; node < _nodes.size(); node++)
+		{
+			if (dependencies[node] == 0)
+			{
+				order.push_back(node);
+			}
+		}
+
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			for (auto to : _successors[order[i]])
+			{
+				if (--dependencies[to] == 0)
+				{
+					order.push_back(to);
+				}
+			}
+		}
+
+		if (order.size() != _nodes.size())
+		{
+			log_error("job graph has a cycle, %zu nodes will never run",
+					  _nodes.size() - order.size());
+			for (NodeID node = 0; node < _nodes.size(); node++)
+			{
+				if (dependencies[node] != 0)
+				{
+					order.push_back(node);
+				}
+			}
+		}
+
+		// once one is turned away the rest goes too, submitJob drops each of them
+		// when whatever it depends on lets go
+		for (auto node : order)
+		{
+			if (_failed)
+			{
+				JobManager::submitJob(_nodes[node]);
+			}
+			else if (!JobManager::submitJob(_nodes[node], &_counter).isValid())
+			{
+				_failed = true;
+			}
+		}
+
+		_submitted = !_failed;
+		return _submitted;
+	}
+
+	void JobGraph::wait() const
+	{
+		if (!_submitted && !_failed)
+		{
+			return;
+		}
+
+		_counter.wait();
+	}
+}
\ No newline at end of file
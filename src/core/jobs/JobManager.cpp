@@ -1,146 +1,1212 @@
 #include "core/jobs/JobManager.h"
+#include "core/jobs/JobPool.h"
 #include "core/jobs/JobTypes.h"
 #include "core/log.h"
+#include "platform/CpuTopology.h"
+#include <algorithm>
 #include <thread>
+#include <utility>
 
 namespace core::jobs
 {
-	void JobManager::initialize()
+	void JobManager::initialize(size_t threadCount, bool useFibers)
 	{
-		// reserve 1 for main
-		int numThreads = (int)std::thread::hardware_concurrency() - 1;
+		// whatever the placement policy leaves after main (and render/tick, if asked)
+		size_t numThreads = threadCount;
+		if (numThreads == 0)
+		{
+			numThreads = platform::CpuTopology::workerCount();
+		}
+
+		numThreads = std::min(numThreads, MaxWorkerThreads);
+		shutdownRequested = false;
+
+		// leave most of the pool for actual cpu work
+		setBlockingLaneSize(std::max<size_t>(1, std::min<size_t>(numThreads / 2, 4)));
+		JobPool::reserve(MaxJobsPerFrame * FramesInFlight);
+
+		for (auto& fence : frameFences)
+		{
+			fence.frame = 0;
+			fence.submitted = 0;
+			for (auto& pending : fence.pending)
+			{
+				pending = 0;
+			}
 
+			fence.waiters.clear();
+			fence.waiting = 0;
+		}
+
+		for (auto& arena : frameArenas)
+		{
+			arena = std::make_unique<FrameArena>();
+		}
+
+		// anything submitted before the first beginFrame goes to frame 1
+		currentFrame = 1;
+		frameFences[1 % FramesInFlight].frame = 1;
+		frameArenas[1 % FramesInFlight]->frame = 1;
+		frameArenas[1 % FramesInFlight]->consumers = 1;
+		frameEnded = false;
+
+		fibersEnabled = useFibers;
+		if (fibersEnabled)
+		{
+			FiberPool::initialize(FiberCount, FiberStackSize);
+		}
 		workerThreads.reserve(numThreads);
 
+		// every worker has to exist before any of them starts, they go through the
+		// whole list when looking for someone to steal from
 		for (size_t i = 0; i < numThreads; i++)
 		{
-			auto thread = std::make_unique<WorkerThread>(i + 1);
+			workerThreads.push_back(std::make_unique<WorkerThread>(i + 1));
+		}
+
+		for (auto& thread : workerThreads)
+		{
 			thread->start();
-			workerThreads.push_back(std::move(thread));
 		}
 
 		log_info("initialized job manager with %d worker threads", numThreads);
 	}
 
-	auto JobManager::getJob(JobID jobId) -> std::shared_ptr<Job>
+	auto JobManager::createJob(Job::WorkFunction work, void* data, JobPriority priority)
+		-> JobHandle
 	{
-		for (auto& queue : jobQueues)
+		auto* job = JobPool::allocate();
+		if (job == nullptr)
 		{
-			std::shared_ptr<Job> job;
-			while (queue.try_dequeue(job))
-			{
-				queue.enqueue(job);
-				if (job->id == jobId)
-				{
-					return job;
-				}
-			}
+			return InvalidJobHandle;
 		}
 
-		return nullptr;
+		job->work = work;
+		job->data = data;
+		job->priority = priority;
+		return job->getHandle();
+	}
+
+	auto JobManager::getJob(JobHandle job) -> Job*
+	{
+		return JobPool::get(job);
+	}
+
+	auto JobManager::submitJob(Job::WorkFunction work, void* data, JobPriority priority,
+							   JobCounter* counter) -> JobHandle
+	{
+		return submitJob(createJob(work, data, priority), counter);
+	}
+
+	auto JobManager::submitBlockingJob(Job::WorkFunction work, void* data,
+									   JobCounter* counter) -> JobHandle
+	{
+		return submitJob(createBlockingJob(work, data), counter);
+	}
+
+	auto JobManager::createBlockingJob(Job::WorkFunction work, void* data) -> JobHandle
+	{
+		auto handle = createJob(work, data, JobPriority::Background);
+		if (auto* job = JobPool::get(handle))
+		{
+			job->blocking = true;
+		}
+
+		return handle;
 	}
 
-	auto JobManager::submitJob(const std::shared_ptr<Job>& job) -> JobID
+	void JobManager::setCleanup(JobHandle handle, Job::CleanupFunction cleanup)
 	{
+		auto* job = JobPool::get(handle);
+		if (job == nullptr || job->state != JobState::Created)
+		{
+			log_error("can't set a cleanup on job %lu, it was already submitted",
+					  handle.toID());
+			return;
+		}
+
+		job->cleanup = cleanup;
+	}
+
+	auto JobManager::submitJob(JobHandle handle, JobCounter* counter) -> JobHandle
+	{
+		auto* job = JobPool::get(handle);
+		if (job == nullptr)
+		{
+			log_error("tried to submit an invalid job handle");
+			return InvalidJobHandle;
+		}
+
+		if (job->state != JobState::Created)
+		{
+			log_error("job %lu was already submitted", handle.toID());
+			return InvalidJobHandle;
+		}
+
         if (shutdownRequested)
         {
             log_warn("sorry, we're closing! (tried to submit job while shutting down)");
-            return InvalidJobID;
+
+			// dependencies still running hold raw pointers to it, so the slot can only
+			// go back once the last of them lets go (makeReady drops it then)
+			job->state.store(JobState::Failed, std::memory_order_release);
+			if (job->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				dropJob(job);
+			}
+			return InvalidJobHandle;
         }
 
+		if (counter != nullptr)
+		{
+			counter->add();
+			job->counter = counter;
+		}
+
 		stats.totalJobsSubmitted++;
-		stats.currentQueueSize++;
-		jobQueues[(size_t)job->priority].enqueue(job);
         job->state = JobState::Waiting;
+
+		job->frame = executingJob != nullptr ? executingJob->frame
+											 : currentFrame.load(std::memory_order_acquire);
+		auto& fence = frameFences[job->frame % FramesInFlight];
+		fence.pending[(size_t)job->priority].fetch_add(1, std::memory_order_relaxed);
+		fence.submitted.fetch_add(1, std::memory_order_relaxed);
+
+		// drop the submission reference, if there's nothing left to wait on it's ready.
+		// after this the job can finish (and its slot get reused) at any moment
+		if (job->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			makeReady(job);
+		}
+
+		return handle;
+	}
+
+	auto JobManager::submitJobAfter(JobHandle handle, const JobCounter& after,
+									JobCounter* counter) -> JobHandle
+	{
+		auto* job = JobPool::get(handle);
+		if (job == nullptr || job->state != JobState::Created)
+		{
+			log_error("tried to submit an invalid job handle");
+			return InvalidJobHandle;
+		}
+
+		// let submitJob turn it away before it ends up on the counter's list
+		if (shutdownRequested)
+		{
+			return submitJob(handle, counter);
+		}
+
+		// the counter holds a reference until it hits 0, same as an unfinished
+		// dependency would. if it's already there, there's nothing to hold
+		job->refCount.fetch_add(1, std::memory_order_relaxed);
+
+		after._lock();
+		bool waiting = after.get() != 0;
+		if (waiting)
+		{
+			job->nextWaiter = after._waiters;
+			after._waiters = job;
+		}
+		after._unlock();
+
+		if (!waiting)
+		{
+			job->refCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		return submitJob(handle, counter);
+	}
+
+	auto JobManager::submitJobAfter(JobHandle handle, FenceID after, JobCounter* counter)
+		-> JobHandle
+	{
+		auto* job = JobPool::get(handle);
+		if (job == nullptr || job->state != JobState::Created)
+		{
+			log_error("tried to submit an invalid job handle");
+			return InvalidJobHandle;
+		}
+
+		if (shutdownRequested || isSignaled(after))
+		{
+			return submitJob(handle, counter);
+		}
+
+		// the counter is held from now on, releaseFenceWaiters submits without one
+		if (counter != nullptr)
+		{
+			counter->add();
+			job->counter = counter;
+		}
+
+		auto& fence = frameFences[(after >> 8) % FramesInFlight];
+		{
+			std::lock_guard lock(fence.waitersLock);
+			fence.waiters.push_back({after, job});
+			fence.waiting.fetch_add(1, std::memory_order_seq_cst);
+		}
+
+		// the fence could have signaled before `waiting` went up, and then whoever
+		// drained it didn't look
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (isSignaled(after))
+		{
+			releaseFenceWaiters(fence);
+		}
+
+		return handle;
+	}
+
+	void JobManager::releaseFenceWaiters(FrameFence& fence)
+	{
+		// shutdown cancels whatever is left, submitting would just drop it
+		if (shutdownRequested)
+		{
+			return;
+		}
+
+		std::vector<Job*> ready;
+		{
+			std::lock_guard lock(fence.waitersLock);
+
+			// check them all before submitting anything, a submission can make the
+			// fence pending again
+			auto signaled = [&](const FenceWaiter& waiter)
+			{
+				if (!isSignaled(waiter.fence))
+				{
+					return false;
+				}
+
+				ready.push_back(waiter.job);
+				return true;
+			};
+
+			fence.waiters.erase(
+				std::remove_if(fence.waiters.begin(), fence.waiters.end(), signaled),
+				fence.waiters.end());
+			fence.waiting.store((uint32_t)fence.waiters.size(), std::memory_order_relaxed);
+		}
+
+		// they belong to whatever frame is current now, not to the job that happened
+		// to finish the fence
+		auto* executing = std::exchange(executingJob, nullptr);
+		for (auto* job : ready)
+		{
+			submitJob(job->getHandle());
+		}
+		executingJob = executing;
+	}
+
+	void JobManager::resumeWaiter(Job* job)
+	{
+		if (job->fiber != nullptr)
+		{
+			makeReady(job);
+			return;
+		}
+
+		if (job->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			makeReady(job);
+		}
+	}
+
+	void JobManager::setDeadline(JobHandle handle, std::chrono::steady_clock::time_point deadline)
+	{
+		auto* job = JobPool::get(handle);
+		if (job == nullptr || job->state != JobState::Created)
+		{
+			log_error("can't set a deadline on job %lu, it was already submitted",
+					  handle.toID());
+			return;
+		}
+
+		// same clock as telemetryNow, and 0 is taken for "no deadline"
+		auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+							   deadline.time_since_epoch())
+							   .count();
+		job->deadline = std::max<uint64_t>(1, nanoseconds);
+	}
+
+	auto JobManager::isComplete(JobHandle job) -> bool
+	{
+		return JobPool::get(job) == nullptr;
+	}
+
+	void JobManager::wait(JobHandle job)
+	{
+		while (!isComplete(job))
+		{
+			pause();
+		}
+	}
+
+	auto JobManager::wait(JobHandle job, std::chrono::milliseconds timeout) -> bool
+	{
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		while (!isComplete(job))
+		{
+			if (std::chrono::steady_clock::now() >= deadline)
+			{
+				return false;
+			}
+
+			pause();
+		}
+
+		return true;
+	}
+
+	auto JobManager::help() -> bool
+	{
+		// a fiber can't resume other fibers, and running jobs on top of it is exactly
+		// what fibers are there to avoid
+		if (Fiber::current() != nullptr)
+		{
+			return false;
+		}
+
+		auto* job = dequeueJob();
+		if (job == nullptr)
+		{
+			return false;
+		}
+
+		if (auto* worker = currentWorkerThread)
+		{
+			worker->executeJob(job);
+		}
+		else
+		{
+			runJob(job);
+		}
+
+		return true;
+	}
+
+	void JobManager::pause()
+	{
+		if (auto* fiber = Fiber::current())
+		{
+			fiber->suspend(FiberStatus::Yielded);
+		}
+		else if (!help())
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	void JobManager::park(const JobCounter* counter)
+	{
+		auto* fiber = Fiber::current();
+		fiber->waitCounter = counter;
+		fiber->suspend(FiberStatus::Parked);
+	}
+
+	auto JobManager::runInline(Job* job) -> bool
+	{
+		auto* previous = std::exchange(executingJob, job);
+		job->execute();
+		executingJob = previous;
+
+		// the job is done, grab the result before the slot goes back to the pool
+		bool completed = job->getState() == JobState::Completed;
+		JobPool::release(job);
+		lastRun = {true, 0};
+		return completed;
+	}
+
+	auto JobManager::runJob(Job* job) -> bool
+	{
+		auto* fiber = job->fiber;
+
+		if (fiber == nullptr)
+		{
+			if (!fibersEnabled)
+			{
+				return runInline(job);
+			}
+
+			fiber = spareFiber != nullptr ? std::exchange(spareFiber, nullptr)
+										  : FiberPool::acquire();
+
+			// out of fibers, this one just won't be able to park
+			if (fiber == nullptr)
+			{
+				return runInline(job);
+			}
+
+			fiber->job = job;
+			job->fiber = fiber;
+		}
+
+		uint64_t sliceStart = telemetryEnabled.load(std::memory_order_relaxed) ? telemetryNow() : 0;
+
+		auto* previous = std::exchange(executingJob, job);
+		fiber->resume();
+		executingJob = previous;
+
+		// still ours until it goes back to a queue or a wait list
+		lastRun = {fiber->status == FiberStatus::Finished, job->runTime};
+		if (!lastRun.finished && sliceStart != 0)
+		{
+			job->runTime += telemetryNow() - sliceStart;
+		}
+
+		// the fiber is off its stack now, so it's safe to hand it to another thread
+		switch (fiber->status)
+		{
+		case FiberStatus::Finished:
+		{
+			bool completed = job->getState() == JobState::Completed;
+			fiber->job = nullptr;
+			JobPool::release(job);
+
+			if (spareFiber == nullptr)
+			{
+				spareFiber = fiber;
+			}
+			else
+			{
+				FiberPool::release(fiber);
+			}
+
+			return completed;
+		}
+
+		case FiberStatus::Parked:
+		{
+			// the counter might have hit 0 while we were switching, in which case
+			// nobody is going to wake us up so it goes right back to the queue
+			const auto* counter = fiber->waitCounter;
+			fiber->waitCounter = nullptr;
+
+			counter->_lock();
+			bool done = counter->get() == 0;
+			if (!done)
+			{
+				job->nextWaiter = counter->_waiters;
+				counter->_waiters = job;
+			}
+			counter->_unlock();
+
+			if (done)
+			{
+				makeReady(job);
+			}
+
+			return false;
+		}
+
+		case FiberStatus::Yielded:
+		{
+			// behind everything else, otherwise we'd pop it right back from our deque
+			stats.currentQueueSize++;
+			activeJobCount.fetch_add(1);
+			Scheduler::onReady((size_t)job->priority);
+
+			if (job->deadline != 0)
+			{
+				Scheduler::pushDeadlineJob(job);
+			}
+			else
+			{
+				jobQueues[(size_t)job->priority].enqueue(job);
+			}
+
+			workAvailable.notify(1);
+			return false;
+		}
+
+		default:
+			return false;
+		}
+	}
+
+	auto JobManager::getTelemetry() -> TelemetrySnapshot
+	{
+		TelemetrySnapshot snapshot;
+		snapshot.workers.reserve(workerThreads.size());
+
+		for (auto& worker : workerThreads)
+		{
+			snapshot.workers.push_back(worker->getTelemetry());
+		}
+
+		snapshot.totalJobsSubmitted = stats.totalJobsSubmitted.load(std::memory_order_relaxed);
+		snapshot.totalJobsExecuted = stats.totalJobsExecuted.load(std::memory_order_relaxed);
+		snapshot.queueSize = stats.currentQueueSize.load(std::memory_order_relaxed);
+		snapshot.averageJobsPerFrame =
+			stats.averageJobsPerFrame.load(std::memory_order_relaxed);
+		snapshot.frame = getFrame();
+
+		Scheduler::fillSnapshot(snapshot.bands);
+		for (const auto& worker : snapshot.workers)
+		{
+			for (size_t band = 0; band < PriorityCount; band++)
+			{
+				auto& total = snapshot.bands[band];
+				total.jobs += worker.bands[band].jobs;
+				total.waitTime += worker.bands[band].waitTime;
+				total.maxWait = std::max(total.maxWait, worker.bands[band].maxWait);
+			}
+		}
+
+		return snapshot;
+	}
+
+	void JobManager::setParkingConfig(const ParkingConfig& config)
+	{
+		spinIterations.store(config.spinIterations, std::memory_order_relaxed);
+		yieldIterations.store(config.yieldIterations, std::memory_order_relaxed);
+	}
+
+	auto JobManager::getParkingConfig() -> ParkingConfig
+	{
+		return {spinIterations.load(std::memory_order_relaxed),
+				yieldIterations.load(std::memory_order_relaxed)};
+	}
+
+	void JobManager::makeReady(Job* job)
+	{
+		// turned away by submitJob while it was still waiting on something
+		if (job->state.load(std::memory_order_acquire) == JobState::Failed)
+		{
+			dropJob(job);
+			return;
+		}
+
+		if (telemetryEnabled.load(std::memory_order_relaxed))
+		{
+			job->readyTime = telemetryNow();
+		}
+
+		stats.currentQueueSize++;
+
+		// a parked blocking job already holds its lane slot, it just needs to resume
+		if (job->blocking && job->fiber == nullptr)
+		{
+			blockingQueue.enqueue(job);
+			workAvailable.notify(1);
+			return;
+		}
+
 		activeJobCount.fetch_add(1);
-		condition.notify_all();
-		return job->id;
+		Scheduler::onReady((size_t)job->priority);
+
+		if (job->deadline != 0)
+		{
+			Scheduler::pushDeadlineJob(job);
+		}
+		else
+		{
+			enqueueJob(job);
+		}
+
+		workAvailable.notify(1);
 	}
 
-	auto JobManager::dequeueJob() -> std::shared_ptr<Job>
+	void JobManager::enqueueJob(Job* job)
 	{
-        // higher priority first by default (i think)
-        for (auto& queue : jobQueues)
-        {
-            // empty, move on
-            if (queue.size_approx() == 0)
-            {
-                continue;
-            }
-
-			std::shared_ptr<Job> job;
-            if (!queue.try_dequeue(job))
-            {
-                continue;
-            }
-
-            // job is ready to be executed
-            if (job->refCount == 0)
-            {
+		// workers keep their own jobs, everyone else goes through the shared queues
+		if (auto* worker = currentWorkerThread)
+		{
+			worker->deques[(size_t)job->priority].push(job);
+		}
+		else
+		{
+			jobQueues[(size_t)job->priority].enqueue(job);
+		}
+	}
+
+	auto JobManager::dequeueJob() -> Job*
+	{
+		auto* worker = currentWorkerThread;
+
+		// a band that's been starved for too long (or sits on a missed deadline) gets
+		// one job in before the usual order
+		size_t urgent = Scheduler::urgentBand();
+		if (urgent != Scheduler::NoBand)
+		{
+			if (auto* job = takeFromBand(worker, urgent))
+			{
+				return job;
+			}
+		}
+
+		// higher priority first, bands that used up their share of the frame only get
+		// looked at once nothing else has work
+		uint32_t deferred = Scheduler::overBudgetBands();
+		for (size_t priority = 0; priority < PriorityCount; priority++)
+		{
+			if ((deferred & (1U << priority)) != 0)
+			{
+				continue;
+			}
+
+			if (auto* job = takeFromBand(worker, priority))
+			{
+				return job;
+			}
+		}
+
+		for (size_t priority = 0; deferred != 0 && priority < PriorityCount; priority++)
+		{
+			if ((deferred & (1U << priority)) == 0)
+			{
+				continue;
+			}
+
+			if (auto* job = takeFromBand(worker, priority))
+			{
+				return job;
+			}
+		}
+
+		return nullptr;
+	}
+
+	auto JobManager::takeFromBand(WorkerThread* worker, size_t priority) -> Job*
+	{
+		// the blocking lane goes right before background work. only workers take from
+		// it, main helping out shouldn't end up stuck on a disk read
+		if (priority == (size_t)JobPriority::Background && worker != nullptr)
+		{
+			if (auto* blocking = dequeueBlockingJob())
+			{
 				stats.currentQueueSize--;
 				stats.totalJobsExecuted++;
-				activeJobCount.fetch_sub(1);
-                condition.notify_all();
-                return job;
-            }
+				return blocking;
+			}
+		}
+
+		// for each level we go deadlines -> local -> shared -> steal. everything in a
+		// queue is ready to run, blocked jobs are never enqueued
+		Job* job = Scheduler::popDeadlineJob(priority);
+
+		if (job == nullptr && worker != nullptr)
+		{
+			job = worker->deques[priority].pop();
+		}
+
+		if (job == nullptr && jobQueues[priority].size_approx() != 0)
+		{
+			jobQueues[priority].try_dequeue(job);
+		}
+
+		if (job == nullptr)
+		{
+			job = stealJob(worker, priority);
+		}
+
+		if (job == nullptr)
+		{
+			return nullptr;
+		}
+
+		stats.currentQueueSize--;
+		activeJobCount.fetch_sub(1);
+		Scheduler::onTaken(priority);
+
+		// a fiber coming back from a park or a yield was counted the first time around
+		if (job->fiber == nullptr)
+		{
+			stats.totalJobsExecuted++;
+		}
+		return job;
+	}
+
+	auto JobManager::dequeueBlockingJob() -> Job*
+	{
+		if (blockingQueue.size_approx() == 0)
+		{
+			return nullptr;
+		}
+
+		// grab a slot in the lane first, it's given back when the job completes
+		uint32_t running = blockingRunning.load(std::memory_order_relaxed);
+		do
+		{
+			if (running >= blockingLaneSize.load(std::memory_order_relaxed))
+			{
+				return nullptr;
+			}
+		} while (!blockingRunning.compare_exchange_weak(running, running + 1));
+
+		Job* job = nullptr;
+		if (!blockingQueue.try_dequeue(job))
+		{
+			blockingRunning.fetch_sub(1);
+			return nullptr;
+		}
+
+		return job;
+	}
+
+	auto JobManager::hasBlockingWork() -> bool
+	{
+		return blockingQueue.size_approx() != 0 &&
+			   blockingRunning.load() < blockingLaneSize.load(std::memory_order_relaxed);
+	}
+
+	auto JobManager::stealJob(WorkerThread* thief, size_t priority) -> Job*
+	{
+		size_t count = workerThreads.size();
+		if (count == 0)
+		{
+			return nullptr;
+		}
+
+		// xorshift, we only need the victims to be spread out, not good randomness
+		stealSeed ^= stealSeed << 13;
+		stealSeed ^= stealSeed >> 17;
+		stealSeed ^= stealSeed << 5;
+
+		size_t start = stealSeed % count;
+		for (size_t i = 0; i < count; i++)
+		{
+			auto* victim = workerThreads[(start + i) % count].get();
+			if (victim == thief)
+			{
+				continue;
+			}
 
-            // its not
-            queue.enqueue(job);
+			if (auto* job = victim->deques[priority].steal())
+			{
+				if (thief != nullptr)
+				{
+					WorkerTelemetry::add(thief->telemetry.steals, 1);
+				}
+
+				return job;
+			}
 		}
 
-        return nullptr;
+		return nullptr;
 	}
 
-	void JobManager::beginFrame()
+	auto JobManager::beginFrame() -> FrameID
 	{
-		
+		// in case the last frame never got ended
+		endFrame();
+
+		FrameID frame = currentFrame.load(std::memory_order_relaxed) + 1;
+		auto& fence = frameFences[frame % FramesInFlight];
+		auto& arena = *frameArenas[frame % FramesInFlight];
+
+		// that slot belongs to a frame FramesInFlight frames ago, which has to be done
+		// before we can reuse it. this is what keeps frames from piling up
+		auto isFree = [&]()
+		{
+			return fence.isDrained() && arena.consumers.load(std::memory_order_acquire) == 0;
+		};
+
+		if (!isFree())
+		{
+			log_trace("frame %lu is still in use, waiting before starting %lu",
+					  arena.frame.load(), frame);
+
+			while (!isFree())
+			{
+				pause();
+			}
+		}
+
+		// nothing can be pointing into the arena anymore
+		arena.pool.reset();
+		arena.consumers.store(1, std::memory_order_relaxed);
+		arena.frame.store(frame, std::memory_order_release);
+
+		fence.submitted.store(0, std::memory_order_relaxed);
+		fence.frame.store(frame, std::memory_order_release);
+		currentFrame.store(frame, std::memory_order_release);
+		frameEnded = false;
+		frameStartTime = telemetryNow();
+		Scheduler::beginFrame();
+
+		// the frame that had the slot is done, and a fence of the new one is signaled
+		// until something gets submitted to it
+		if (fence.waiting.load(std::memory_order_seq_cst) != 0)
+		{
+			releaseFenceWaiters(fence);
+		}
+
+		return frame;
 	}
 
 	void JobManager::endFrame()
 	{
+		if (frameEnded)
+		{
+			return;
+		}
+
+		frameEnded = true;
 
+		FrameID frame = currentFrame.load(std::memory_order_relaxed);
+		uint32_t submitted =
+			frameFences[frame % FramesInFlight].submitted.load(std::memory_order_relaxed);
+
+		if (submitted > MaxJobsPerFrame)
+		{
+			log_warn("frame %lu submitted %d jobs (more than the %d budgeted per frame)",
+					 frame, submitted, MaxJobsPerFrame);
+		}
+
+		// moving averages over roughly the last 16 frames
+		uint64_t average = stats.averageJobsPerFrame.load(std::memory_order_relaxed);
+		stats.averageJobsPerFrame.store((average * 15 + submitted) / 16,
+										std::memory_order_relaxed);
+
+		if (frameStartTime != 0)
+		{
+			auto frameTime =
+				std::chrono::microseconds((telemetryNow() - frameStartTime) / 1000);
+			auto averageFrame = stats.averageFrameTime.load(std::memory_order_relaxed);
+			stats.averageFrameTime.store((averageFrame * 15 + frameTime) / 16,
+										 std::memory_order_relaxed);
+		}
+
+		uint64_t jobs = 0;
+		uint64_t executionTime = 0;
+		for (auto& worker : workerThreads)
+		{
+			jobs += worker->telemetry.jobsExecuted.load(std::memory_order_relaxed);
+			executionTime += worker->telemetry.executionTime.load(std::memory_order_relaxed);
+		}
+
+		if (jobs != 0)
+		{
+			stats.averageJobExecutionTime.store(
+				std::chrono::microseconds(executionTime / jobs / 1000),
+				std::memory_order_relaxed);
+		}
+
+		releaseFrame(frame);
+	}
+
+	auto JobManager::getFrameMemory(FrameID frame) -> FrameMemoryPool*
+	{
+		if (frame == 0)
+		{
+			frame = getFrame();
+		}
+
+		auto& arena = frameArenas[frame % FramesInFlight];
+		if (!arena || arena->frame.load(std::memory_order_acquire) != frame)
+		{
+			return nullptr;
+		}
+
+		return &arena->pool;
+	}
+
+	auto JobManager::retainFrame(FrameID frame) -> bool
+	{
+		auto& arena = *frameArenas[frame % FramesInFlight];
+
+		// the count can't go from 0 back up, once it's released the slot is up for grabs
+		uint32_t consumers = arena.consumers.load(std::memory_order_relaxed);
+		do
+		{
+			if (consumers == 0 || arena.frame.load(std::memory_order_acquire) != frame)
+			{
+				log_error("tried to retain frame %lu after it was released", frame);
+				return false;
+			}
+		} while (!arena.consumers.compare_exchange_weak(consumers, consumers + 1,
+														std::memory_order_acq_rel));
+
+		return true;
+	}
+
+	void JobManager::releaseFrame(FrameID frame)
+	{
+		auto& arena = *frameArenas[frame % FramesInFlight];
+		if (arena.frame.load(std::memory_order_acquire) != frame)
+		{
+			log_error("tried to release frame %lu, but it's already gone", frame);
+			return;
+		}
+
+		arena.consumers.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	auto JobManager::getExecutingFrame() -> FrameID
+	{
+		return executingJob != nullptr ? executingJob->frame
+									   : currentFrame.load(std::memory_order_acquire);
+	}
+
+	auto JobManager::createFence(JobPriority priority, FrameID frame) -> FenceID
+	{
+		if (frame == 0)
+		{
+			frame = getFrame();
+		}
+
+		// frame in the high bits, priority + 1 in the low byte (0 means every priority)
+		return (frame << 8) | ((FenceID)priority + 1);
+	}
+
+	auto JobManager::createFrameFence(FrameID frame) -> FenceID
+	{
+		if (frame == 0)
+		{
+			frame = getFrame();
+		}
+
+		return frame << 8;
+	}
+
+	auto JobManager::isSignaled(FenceID fenceId) -> bool
+	{
+		FrameID frame = fenceId >> 8;
+		size_t priority = fenceId & 0xFF;
+
+		if (fenceId == InvalidFenceID)
+		{
+			return true;
+		}
+
+		const auto& fence = frameFences[frame % FramesInFlight];
+		FrameID slotFrame = fence.frame.load(std::memory_order_acquire);
+
+		// a slot only gets reused once it's drained, so a newer frame in there means
+		// ours finished a while ago. an older one means ours didn't even start
+		if (slotFrame != frame)
+		{
+			return slotFrame > frame;
+		}
+
+		if (priority == 0)
+		{
+			return fence.isDrained();
+		}
+
+		return fence.pending[priority - 1].load(std::memory_order_acquire) == 0;
+	}
+
+	void JobManager::waitForFence(FenceID fence)
+	{
+		while (!isSignaled(fence))
+		{
+			pause();
+		}
 	}
 
 	void JobManager::shutdown()
 	{
         shutdownRequested = true;
-		condition.notify_all();
+		workAvailable.notifyAll();
 
 		for (auto& thread : workerThreads)
 		{
 			thread->stop();
 		}
 
+		// whatever didn't get to run gets cancelled. that can make its successors
+		// ready, which land right back in the queues, so go again until it's all gone
+		bool cancelled = true;
+		while (cancelled)
+		{
+			cancelled = false;
+
+			Job* job = nullptr;
+			for (auto& queue : jobQueues)
+			{
+				while (queue.try_dequeue(job))
+				{
+					cancelJob(job);
+					cancelled = true;
+				}
+			}
+
+			while (blockingQueue.try_dequeue(job))
+			{
+				cancelJob(job);
+				cancelled = true;
+			}
+
+			for (auto* deadlineJob : Scheduler::drain())
+			{
+				cancelJob(deadlineJob);
+				cancelled = true;
+			}
+
+			// never submitted, so they aren't on any frame yet. they go on the current
+			// one so cancelJob can settle them like everything else
+			for (auto& fence : frameFences)
+			{
+				std::vector<FenceWaiter> waiters;
+				{
+					std::lock_guard lock(fence.waitersLock);
+					waiters.swap(fence.waiters);
+					fence.waiting.store(0, std::memory_order_relaxed);
+				}
+
+				for (auto& waiter : waiters)
+				{
+					auto* waiting = waiter.job;
+					waiting->state = JobState::Waiting;
+					waiting->frame = currentFrame.load(std::memory_order_relaxed);
+					frameFences[waiting->frame % FramesInFlight]
+						.pending[(size_t)waiting->priority]
+						.fetch_add(1, std::memory_order_relaxed);
+					cancelJob(waiting);
+					cancelled = true;
+				}
+			}
+
+			for (auto& thread : workerThreads)
+			{
+				for (auto& deque : thread->deques)
+				{
+					while (auto* queued = deque.steal())
+					{
+						cancelJob(queued);
+						cancelled = true;
+					}
+				}
+			}
+		}
+
+		blockingRunning = 0;
+		activeJobCount = 0;
+		stats.currentQueueSize = 0;
+
+		if (fibersEnabled)
+		{
+			if (spareFiber != nullptr)
+			{
+				FiberPool::release(spareFiber);
+				spareFiber = nullptr;
+			}
+
+			FiberPool::shutdown();
+			fibersEnabled = false;
+		}
+
+		for (auto& arena : frameArenas)
+		{
+			arena.reset();
+		}
+
 		workerThreads.clear();
 	}
 
-	void JobManager::addDependency(const std::shared_ptr<Job>& dependent,
-								   const std::shared_ptr<Job>& dependency)
+	void JobManager::cancelJob(Job* job)
 	{
-		std::lock_guard<std::mutex> lock(mutex);
-		dependent->refCount.fetch_add(1, std::memory_order_relaxed);
-		dependents[dependency->id].push_back(std::shared_ptr<Job>(dependent));
+		// a parked fiber already started, the rest of it still has to run
+		if (job->fiber != nullptr)
+		{
+			runJob(job);
+			return;
+		}
+
+		if (job->cleanup != nullptr)
+		{
+			job->cleanup(job->data);
+		}
+
+		// it never took a slot in the blocking lane, so there's none to give back
+		job->blocking = false;
+		job->state.store(JobState::Failed, std::memory_order_release);
+		onComplete(job);
+		JobPool::release(job);
+	}
+
+	void JobManager::dropJob(Job* job)
+	{
+		// it never got a frame or a counter, the only ones to tell are its successors
+		job->lockSuccessors();
+		job->finished = true;
+		job->unlockSuccessors();
+
+		for (auto* successor : job->successors)
+		{
+			if (successor->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				makeReady(successor);
+			}
+		}
+
+		JobPool::release(job);
 	}
 
-	void JobManager::onComplete(JobID id)
+	void JobManager::addDependency(JobHandle dependentHandle, JobHandle dependencyHandle)
 	{
-		std::vector<std::shared_ptr<Job>> dependents;
+		auto* dependent = JobPool::get(dependentHandle);
+		if (dependent == nullptr || dependent->state != JobState::Created)
+		{
+			log_error("can't add a dependency to job %lu, it was already submitted",
+					  dependentHandle.toID());
+			return;
+		}
 
+		// a stale handle means the dependency already finished
+		auto* dependency = JobPool::get(dependencyHandle);
+		if (dependency == nullptr)
 		{
-			std::lock_guard lock(mutex);
+			return;
+		}
 
-			auto it = JobManager::dependents.find(id);
-			if (it != JobManager::dependents.end())
+		dependency->lockSuccessors();
+
+		// it could have finished and been recycled since we looked it up, the
+		// generation only changes under this lock so checking again here is enough
+		if (dependency->generation.load(std::memory_order_relaxed) ==
+				dependencyHandle.generation &&
+			!dependency->finished)
+		{
+			dependent->refCount.fetch_add(1, std::memory_order_relaxed);
+			dependency->successors.push_back(dependent);
+		}
+
+		dependency->unlockSuccessors();
+	}
+
+	void JobManager::onComplete(Job* job)
+	{
+		// free up the lane, and if something was waiting on it get somebody to run it
+		if (job->blocking)
+		{
+			blockingRunning.fetch_sub(1);
+			if (blockingQueue.size_approx() != 0)
 			{
-				dependents = std::move(it->second);
-				JobManager::dependents.erase(it);
+				workAvailable.notify(1);
 			}
 		}
 
-		for (auto& dependent : dependents)
+		// nobody can add successors once finished is set, so the list can be walked
+		// without holding the lock (and keeps its capacity for the next job in the slot)
+		job->lockSuccessors();
+		job->finished = true;
+		job->unlockSuccessors();
+
+		// the last dependency to finish is the one that hands the job to the workers
+		for (auto* successor : job->successors)
+		{
+			if (successor->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				makeReady(successor);
+			}
+		}
+
+		if (job->counter != nullptr)
+		{
+			job->counter->decrement();
+		}
+
+		// seq_cst pairs with submitJobAfter, one of the two always sees the other
+		auto& fence = frameFences[job->frame % FramesInFlight];
+		if (fence.pending[(size_t)job->priority].fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+			fence.waiting.load(std::memory_order_seq_cst) != 0)
 		{
-			dependent->refCount.fetch_sub(1, std::memory_order_acq_rel);
-			submitJob({dependent});
+			releaseFenceWaiters(fence);
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "core/jobs/JobPool.h"
+#include "core/log.h"
+
+namespace core::jobs
+{
+	thread_local JobPool::LocalCache JobPool::cache;
+
+	JobPool::LocalCache::~LocalCache()
+	{
+		// hand everything back so slots don't get lost with the thread
+		if (count != 0)
+		{
+			_flush(*this, count);
+		}
+	}
+
+	void JobPool::reserve(size_t jobCount)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		while (capacity() < jobCount && chunkCount < MaxChunks)
+		{
+			_grow();
+		}
+	}
+
+	auto JobPool::allocate() -> Job*
+	{
+		if (cache.count == 0 && !_refill(cache))
+		{
+			return nullptr;
+		}
+
+		return _slot(cache.indices[--cache.count]);
+	}
+
+	void JobPool::release(Job* job)
+	{
+		// bump the generation so every handle to this job goes stale. it's done under
+		// the successor lock so addDependency can't see a half-recycled job
+		uint32_t generation = job->generation.load(std::memory_order_relaxed) + 1;
+		if (generation == 0)
+		{
+			generation = 1;
+		}
+
+		job->lockSuccessors();
+		job->generation.store(generation, std::memory_order_release);
+		job->successors.clear();
+		job->finished = false;
+		job->unlockSuccessors();
+
+		job->state.store(JobState::Created, std::memory_order_relaxed);
+		job->refCount.store(1, std::memory_order_relaxed);
+		job->counter = nullptr;
+		job->fiber = nullptr;
+		job->nextWaiter = nullptr;
+		job->blocking = false;
+		job->deadline = 0;
+		job->work = nullptr;
+		job->data = nullptr;
+		job->cleanup = nullptr;
+		job->runTime = 0;
+
+		if (cache.count == CacheSize)
+		{
+			_flush(cache, TransferBatch);
+		}
+
+		cache.indices[cache.count++] = job->index;
+	}
+
+	auto JobPool::get(JobHandle handle) -> Job*
+	{
+		if (!handle.isValid() || handle.index >= capacity())
+		{
+			return nullptr;
+		}
+
+		auto* job = _slot(handle.index);
+		if (job->generation.load(std::memory_order_acquire) != handle.generation)
+		{
+			return nullptr;
+		}
+
+		return job;
+	}
+
+	void JobPool::_grow()
+	{
+		// mutex is held by the caller
+		uint32_t chunk = chunkCount.load(std::memory_order_relaxed);
+		auto* jobs = new Job[ChunkSize];
+
+		for (uint32_t i = 0; i < ChunkSize; i++)
+		{
+			jobs[i].index = chunk * ChunkSize + i;
+		}
+
+		chunks[chunk].store(jobs, std::memory_order_release);
+		chunkCount.store(chunk + 1, std::memory_order_release);
+
+		// reversed so the lowest indices get handed out first
+		for (uint32_t i = ChunkSize; i > 0; i--)
+		{
+			freeList.push_back(chunk * ChunkSize + i - 1);
+		}
+	}
+
+	auto JobPool::_refill(LocalCache& cache) -> bool
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (freeList.empty())
+		{
+			if (chunkCount.load(std::memory_order_relaxed) == MaxChunks)
+			{
+				log_error("ran out of job slots (%d in flight)", capacity());
+				return false;
+			}
+
+			log_trace("job pool ran dry, growing to %d slots", capacity() + ChunkSize);
+			_grow();
+		}
+
+		while (cache.count < TransferBatch && !freeList.empty())
+		{
+			cache.indices[cache.count++] = freeList.back();
+			freeList.pop_back();
+		}
+
+		return true;
+	}
+
+	void JobPool::_flush(LocalCache& cache, uint32_t count)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			freeList.push_back(cache.indices[--cache.count]);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "core/jobs/Parallel.h"
+#include "core/jobs/JobCounter.h"
+#include "core/jobs/JobManager.h"
+
+namespace core::jobs::internals
+{
+	namespace
+	{
+		void runChunks(ParallelRange& range)
+		{
+			while (true)
+			{
+				size_t chunk = range.next.fetch_add(1, std::memory_order_relaxed);
+				if (chunk >= range.chunkCount)
+				{
+					return;
+				}
+
+				size_t first = range.begin + chunk * range.grain;
+				size_t last = std::min(first + range.grain, range.end);
+				range.run(range.body, chunk, first, last);
+			}
+		}
+
+		void helperJob(Job* /*job*/, void* data)
+		{
+			auto& range = *static_cast<ParallelRange*>(data);
+
+			// the job system would just log it, the caller has to see it instead
+			try
+			{
+				runChunks(range);
+			}
+			catch (...)
+			{
+				range.next.store(range.chunkCount, std::memory_order_relaxed);
+				if (!range.failed.exchange(true, std::memory_order_acq_rel))
+				{
+					range.error = std::current_exception();
+				}
+			}
+		}
+	}
+
+	auto resolveGrain(size_t count, size_t grain) -> size_t
+	{
+		if (grain != 0)
+		{
+			return grain;
+		}
+
+		// ~8 chunks per thread is enough to even out uneven chunks without paying
+		// too much for claiming them
+		size_t threads = JobManager::threadCount() + 1;
+		return std::max<size_t>(1, count / (threads * 8));
+	}
+
+	void parallelDispatch(ParallelRange& range, JobPriority priority)
+	{
+		// no point in waking anybody up for a single chunk
+		size_t helpers = std::min(JobManager::threadCount(), range.chunkCount - 1);
+
+		JobCounter counter;
+		for (size_t i = 0; i < helpers; i++)
+		{
+			JobManager::submitJob(&helperJob, &range, priority, &counter);
+		}
+
+		try
+		{
+			runChunks(range);
+		}
+		catch (...)
+		{
+			// the helpers still point at our stack, let them finish before unwinding
+			range.next.store(range.chunkCount, std::memory_order_relaxed);
+			counter.wait();
+			throw;
+		}
+
+		// helpers that haven't started yet will find nothing left and exit right away,
+		// meanwhile we run whatever else is queued instead of just sleeping
+		counter.wait();
+
+		if (range.error)
+		{
+			std::rethrow_exception(range.error);
+		}
+	}
+}
\ No newline at end of file
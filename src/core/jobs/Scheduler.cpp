@@ -0,0 +1,224 @@
+#include "core/jobs/Scheduler.h"
+#include "core/jobs/Job.h"
+#include "core/jobs/Telemetry.h"
+#include <algorithm>
+
+namespace core::jobs
+{
+	namespace
+	{
+		auto laterDeadline(const Job* a, const Job* b) -> bool
+		{
+			return a->getDeadline() > b->getDeadline();
+		}
+	}
+
+	void Scheduler::setConfig(const SchedulerConfig& config)
+	{
+		bool shares = false;
+		for (size_t band = 0; band < PriorityCount; band++)
+		{
+			auto threshold =
+				std::chrono::duration_cast<std::chrono::nanoseconds>(config.agingThreshold[band]);
+			agingThreshold[band].store(threshold.count(), std::memory_order_relaxed);
+
+			float share = std::clamp(config.timeShare[band], 0.0F, 1.0F);
+			timeShare[band].store(share, std::memory_order_relaxed);
+			shares |= share < 1.0F;
+		}
+
+		sharesEnabled.store(shares, std::memory_order_relaxed);
+	}
+
+	auto Scheduler::getConfig() -> SchedulerConfig
+	{
+		SchedulerConfig config;
+		for (size_t band = 0; band < PriorityCount; band++)
+		{
+			config.agingThreshold[band] = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::nanoseconds(agingThreshold[band].load(std::memory_order_relaxed)));
+			config.timeShare[band] = timeShare[band].load(std::memory_order_relaxed);
+		}
+
+		return config;
+	}
+
+	void Scheduler::onReady(size_t band)
+	{
+		// waiting starts counting when the band goes from nothing to do to something,
+		// not from whenever it was last served
+		if (bands[band].ready.fetch_add(1, std::memory_order_relaxed) == 0)
+		{
+			bands[band].lastServed.store(telemetryNow(), std::memory_order_relaxed);
+		}
+	}
+
+	void Scheduler::onTaken(size_t band)
+	{
+		// a band that keeps getting served isn't starving, however busy it is
+		bands[band].ready.fetch_sub(1, std::memory_order_relaxed);
+		bands[band].lastServed.store(telemetryNow(), std::memory_order_relaxed);
+	}
+
+	auto Scheduler::urgentBand() -> size_t
+	{
+		// nothing below critical has work, which is the common case
+		bool waiting = false;
+		for (size_t band = 1; band < PriorityCount; band++)
+		{
+			waiting |= bands[band].ready.load(std::memory_order_relaxed) != 0;
+		}
+
+		if (!waiting && bands[0].earliest.load(std::memory_order_relaxed) == 0)
+		{
+			return NoBand;
+		}
+
+		uint64_t now = telemetryNow();
+		for (size_t band = 0; band < PriorityCount; band++)
+		{
+			auto& state = bands[band];
+
+			uint64_t earliest = state.earliest.load(std::memory_order_relaxed);
+			if (earliest != 0 && earliest <= now)
+			{
+				return band;
+			}
+
+			uint64_t threshold = agingThreshold[band].load(std::memory_order_relaxed);
+			if (threshold == 0 || state.ready.load(std::memory_order_relaxed) == 0)
+			{
+				continue;
+			}
+
+			uint64_t lastServed = state.lastServed.load(std::memory_order_relaxed);
+			if (now > lastServed && now - lastServed > threshold)
+			{
+				// pretend it got served, so the rest of the workers don't all pile
+				// onto it. it's a nudge, the band gets one job per threshold out of it
+				if (state.lastServed.compare_exchange_strong(lastServed, now,
+															 std::memory_order_relaxed))
+				{
+					state.aged.fetch_add(1, std::memory_order_relaxed);
+					return band;
+				}
+			}
+		}
+
+		return NoBand;
+	}
+
+	auto Scheduler::overBudgetBands() -> uint32_t
+	{
+		if (!hasShares())
+		{
+			return 0;
+		}
+
+		uint64_t times[PriorityCount];
+		uint64_t total = 0;
+		for (size_t band = 0; band < PriorityCount; band++)
+		{
+			times[band] = bands[band].frameTime.load(std::memory_order_relaxed);
+			total += times[band];
+		}
+
+		if (total < MinShareTime)
+		{
+			return 0;
+		}
+
+		uint32_t over = 0;
+		for (size_t band = 0; band < PriorityCount; band++)
+		{
+			float share = timeShare[band].load(std::memory_order_relaxed);
+			if (share < 1.0F && (double)times[band] > (double)total * share)
+			{
+				over |= 1U << band;
+			}
+		}
+
+		return over;
+	}
+
+	void Scheduler::pushDeadlineJob(Job* job)
+	{
+		auto& state = bands[(size_t)job->getPriority()];
+
+		std::lock_guard<std::mutex> lock(state.deadlineLock);
+		state.deadlineJobs.push_back(job);
+		std::push_heap(state.deadlineJobs.begin(), state.deadlineJobs.end(), &laterDeadline);
+		state.earliest.store(state.deadlineJobs.front()->getDeadline(),
+							 std::memory_order_relaxed);
+	}
+
+	auto Scheduler::popDeadlineJob(size_t band) -> Job*
+	{
+		auto& state = bands[band];
+		if (state.earliest.load(std::memory_order_relaxed) == 0)
+		{
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(state.deadlineLock);
+		if (state.deadlineJobs.empty())
+		{
+			return nullptr;
+		}
+
+		std::pop_heap(state.deadlineJobs.begin(), state.deadlineJobs.end(), &laterDeadline);
+		auto* job = state.deadlineJobs.back();
+		state.deadlineJobs.pop_back();
+
+		state.earliest.store(
+			state.deadlineJobs.empty() ? 0 : state.deadlineJobs.front()->getDeadline(),
+			std::memory_order_relaxed);
+		return job;
+	}
+
+	void Scheduler::recordExecution(size_t band, uint64_t elapsed, uint64_t started,
+									uint64_t deadline)
+	{
+		bands[band].frameTime.fetch_add(elapsed, std::memory_order_relaxed);
+
+		if (deadline != 0 && started > deadline)
+		{
+			bands[band].deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void Scheduler::beginFrame()
+	{
+		for (auto& band : bands)
+		{
+			band.frameTime.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	auto Scheduler::drain() -> std::vector<Job*>
+	{
+		std::vector<Job*> jobs;
+		for (auto& band : bands)
+		{
+			std::lock_guard<std::mutex> lock(band.deadlineLock);
+			jobs.insert(jobs.end(), band.deadlineJobs.begin(), band.deadlineJobs.end());
+			band.deadlineJobs.clear();
+			band.earliest.store(0, std::memory_order_relaxed);
+			band.ready.store(0, std::memory_order_relaxed);
+		}
+
+		return jobs;
+	}
+
+	void Scheduler::fillSnapshot(BandSnapshot (&snapshot)[PriorityCount])
+	{
+		for (size_t band = 0; band < PriorityCount; band++)
+		{
+			snapshot[band].aged = bands[band].aged.load(std::memory_order_relaxed);
+			snapshot[band].deadlineMisses =
+				bands[band].deadlineMisses.load(std::memory_order_relaxed);
+			snapshot[band].frameTime = bands[band].frameTime.load(std::memory_order_relaxed);
+			snapshot[band].ready = bands[band].ready.load(std::memory_order_relaxed);
+		}
+	}
+}
@@ -2,10 +2,24 @@
 #include "core/Application.h"
 #include "core/jobs/JobManager.h"
 #include "core/jobs/JobTypes.h"
+#include "core/jobs/Scheduler.h"
+#include "platform/CpuTopology.h"
 #include <chrono>
 
 namespace core::jobs
 {
+	namespace
+	{
+		inline void cpuRelax()
+		{
+#if defined(__x86_64__) || defined(__i386__)
+			__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+			asm volatile("yield");
+#endif
+		}
+	}
+
 	WorkerThread::WorkerThread(ThreadID id)
 	{
 		this->id = id;
@@ -24,6 +38,7 @@ namespace core::jobs
 	void WorkerThread::stop()
 	{
 		requestStop();
+		JobManager::workAvailable.notifyAll();
 
 		if (thread && thread->joinable())
 		{
@@ -33,37 +48,108 @@ namespace core::jobs
 
 	auto WorkerThread::executeNextJob() -> bool
 	{
-		auto job = JobManager::dequeueJob();
+		auto* job = JobManager::dequeueJob();
 
-		if (job)
+		if (job != nullptr)
 		{
-			executeJob(job);
-			return job->getState() == JobState::Completed;
+			return executeJob(job);
 		}
 
         return false;
 	}
 
-	void WorkerThread::executeJob(const std::shared_ptr<Job>& job)
+	auto WorkerThread::executeJob(Job* job) -> bool
 	{
-		auto start = std::chrono::high_resolution_clock::now();
-		job->execute();
-		jobsExecuted.fetch_add(1);
+		// the job might be back in the pool once it ran, grab these first. a resumed
+		// fiber already started, so it can't miss its deadline again
+		size_t band = (size_t)job->priority;
+		bool starting = job->fiber == nullptr;
+		uint64_t deadline = starting ? job->deadline : 0;
+
+		if (!JobManager::telemetryEnabled.load(std::memory_order_relaxed))
+		{
+			if (starting)
+			{
+				WorkerTelemetry::add(telemetry.jobsExecuted, 1);
+			}
+
+			// time shares and deadlines still need the clock
+			if (!Scheduler::hasShares() && deadline == 0)
+			{
+				return JobManager::runJob(job);
+			}
+
+			uint64_t start = telemetryNow();
+			bool completed = JobManager::runJob(job);
+			Scheduler::recordExecution(band, telemetryNow() - start, start, deadline);
+			return completed;
+		}
+
+		uint64_t start = telemetryNow();
+
+		// resuming a parked fiber isn't a start
+		if (starting && job->readyTime != 0)
+		{
+			uint64_t wait = start - job->readyTime;
+			telemetry.latency.record(wait);
+
+			WorkerTelemetry::add(telemetry.bandJobs[band], 1);
+			WorkerTelemetry::add(telemetry.bandWait[band], wait);
+			if (wait > telemetry.bandMaxWait[band].load(std::memory_order_relaxed))
+			{
+				telemetry.bandMaxWait[band].store(wait, std::memory_order_relaxed);
+			}
+		}
+
+		// the job might be back in the pool after this, don't touch it
+		bool completed = JobManager::runJob(job);
+
+		uint64_t elapsed = telemetryNow() - start;
+		WorkerTelemetry::add(telemetry.executionTime, elapsed);
+		Scheduler::recordExecution(band, elapsed, start, deadline);
+
+		// a fiber that parked or yielded comes back later, it's counted once it's done
+		// with every slice it ran in
+		if (starting)
+		{
+			WorkerTelemetry::add(telemetry.jobsExecuted, 1);
+		}
 
-		auto end = std::chrono::high_resolution_clock::now();
+		if (JobManager::lastRun.finished)
+		{
+			telemetry.execution.record(JobManager::lastRun.earlierRunTime + elapsed);
+		}
 
-		totalExecutionTime =
-			totalExecutionTime.load() +
-			std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+		return completed;
+	}
+
+	auto WorkerThread::getTelemetry() const -> WorkerSnapshot
+	{
+		WorkerSnapshot snapshot;
+		snapshot.id = id;
+		snapshot.latency = telemetry.latency.snapshot();
+		snapshot.execution = telemetry.execution.snapshot();
+		snapshot.jobsExecuted = telemetry.jobsExecuted.load(std::memory_order_relaxed);
+		snapshot.executionTime = telemetry.executionTime.load(std::memory_order_relaxed);
+		snapshot.steals = telemetry.steals.load(std::memory_order_relaxed);
+		snapshot.idleTime = telemetry.idleTime.load(std::memory_order_relaxed);
+		snapshot.parks = telemetry.parks.load(std::memory_order_relaxed);
+
+		for (size_t band = 0; band < PriorityCount; band++)
+		{
+			snapshot.bands[band].jobs = telemetry.bandJobs[band].load(std::memory_order_relaxed);
+			snapshot.bands[band].waitTime =
+				telemetry.bandWait[band].load(std::memory_order_relaxed);
+			snapshot.bands[band].maxWait =
+				telemetry.bandMaxWait[band].load(std::memory_order_relaxed);
+		}
+		return snapshot;
 	}
 
 	void WorkerThread::workerThreadMain()
 	{
-        // set affinity
-		cpu_set_t cpuset;
-		CPU_ZERO(&cpuset);
-		CPU_SET(id % std::thread::hardware_concurrency(), &cpuset);
-		pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+		// ids start at 1, 0 is main
+		platform::CpuTopology::applyToCurrentThread(platform::ThreadRole::Worker, id - 1);
 
 		pthread_setname_np(pthread_self(), "worker");
 
@@ -76,19 +162,80 @@ namespace core::jobs
 		pthread_setschedparam(pthread_self(), policy, &param);
 
 		JobManager::currentWorkerThread = this;
+		JobManager::stealSeed = (id * 2654435761U) | 1U;
+
+		uint32_t idle = 0;
+		uint64_t idleStart = 0;
 
 		while (!shouldStop)
 		{
-			std::unique_lock<std::mutex> lock(mutex);
-			JobManager::condition.wait(
-				lock, [=]() { return JobManager::activeJobCount != 0 || JobManager::shutdownRequested; });
+			if (auto* job = JobManager::dequeueJob())
+			{
+				if (idleStart != 0)
+				{
+					WorkerTelemetry::add(telemetry.idleTime, telemetryNow() - idleStart);
+					idleStart = 0;
+				}
+
+				executeJob(job);
+				idle = 0;
+				continue;
+			}
+
+			if (idleStart == 0 && JobManager::telemetryEnabled.load(std::memory_order_relaxed))
+			{
+				idleStart = telemetryNow();
+			}
+
+			// nothing to do, look again for a bit before going to sleep
+			uint32_t spins = JobManager::spinIterations.load(std::memory_order_relaxed);
+			uint32_t yields = JobManager::yieldIterations.load(std::memory_order_relaxed);
+
+			if (idle < spins)
+			{
+				cpuRelax();
+				idle++;
+				continue;
+			}
+
+			if (idle < spins + yields)
+			{
+				std::this_thread::yield();
+				idle++;
+				continue;
+			}
+
+			park();
+			idle = 0;
+		}
 
-			executeNextJob();
+		if (JobManager::spareFiber != nullptr)
+		{
+			FiberPool::release(JobManager::spareFiber);
+			JobManager::spareFiber = nullptr;
 		}
 
 		JobManager::currentWorkerThread = nullptr;
 	}
 
+	void WorkerThread::park()
+	{
+		auto& event = JobManager::workAvailable;
+		auto key = event.prepareWait();
+
+		// anything made ready after prepareWait is going to wake us up, so this is the
+		// last check needed before sleeping
+		if (JobManager::activeJobCount.load() != 0 || JobManager::hasBlockingWork() ||
+			JobManager::shutdownRequested || shouldStop)
+		{
+			event.cancelWait();
+			return;
+		}
+
+		WorkerTelemetry::add(telemetry.parks, 1);
+		event.commitWait(key);
+	}
+
 	void WorkerThread::yield()
 	{
 		executeNextJob();
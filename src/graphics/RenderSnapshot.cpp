@@ -0,0 +1,127 @@
+#include "graphics/RenderSnapshot.h"
+#include "core/Application.h"
+#include "core/Entity.h"
+#include "core/Scene.h"
+#include <algorithm>
+
+namespace graphics
+{
+	void RenderSnapshots::extract(core::Scene* scene, uint64_t tick)
+	{
+		auto& snapshot = buffers[back];
+		const auto& previous = hasCapture ? captured : buffers[last];
+
+		snapshot.clear();
+		snapshot.tick = tick;
+
+		lastIndex.clear();
+		for (uint32_t i = 0; i < previous.entities.size(); i++)
+		{
+			lastIndex[previous.entities[i]] = i;
+		}
+
+		for (auto* entity : scene->getEntities())
+		{
+			_extractEntity(entity, snapshot, previous);
+		}
+
+		auto viewport = core::Application::main != nullptr
+							? core::Application::main->getWindow()->getSize()
+							: math::Vector2();
+
+		for (auto* camera : scene->getCameras())
+		{
+			// the viewport used to get pushed in from the render thread, now it's picked
+			// up here and the new projection shows up next tick
+			camera->setViewportSize(viewport);
+
+			CameraView view;
+			view.entity = camera->getEntity()->getID();
+			view.renderOrder = camera->getRenderOrder();
+			view.view = camera->getView();
+			view.projection = camera->getProjection();
+			snapshot.cameras.push_back(view);
+		}
+
+		hasCapture = false;
+
+		// back becomes the spare, whatever was spare (stale or not) is ours to write next
+		last = back;
+		back = spare.exchange(back | FreshBit, std::memory_order_acq_rel) & ~FreshBit;
+	}
+
+	void RenderSnapshots::_extractEntity(core::Entity* entity, RenderSnapshot& snapshot,
+										 const RenderSnapshot& previous)
+	{
+		if (!entity->isActive())
+		{
+			return;
+		}
+
+		auto index = (uint32_t)snapshot.entities.size();
+		auto id = entity->getID();
+		auto world = entity->transform.getWorldMatrix();
+
+		snapshot.entities.push_back(id);
+		snapshot.world.push_back(world);
+		snapshot.visible.push_back(entity->isVisible() ? 1 : 0);
+
+		// same spot as last time is the common case, skip the lookup then
+		if (index < previous.entities.size() && previous.entities[index] == id)
+		{
+			snapshot.previousWorld.push_back(previous.world[index]);
+		}
+		else if (auto it = lastIndex.find(id); it != lastIndex.end())
+		{
+			snapshot.previousWorld.push_back(previous.world[it->second]);
+		}
+		else
+		{
+			// new this tick, nothing to blend from
+			snapshot.previousWorld.push_back(world);
+		}
+
+		for (auto* child : entity->getChildren())
+		{
+			_extractEntity(child, snapshot, previous);
+		}
+	}
+
+	void RenderSnapshots::capturePrevious(core::Scene* scene)
+	{
+		captured.clear();
+		for (auto* entity : scene->getEntities())
+		{
+			_captureEntity(entity);
+		}
+
+		hasCapture = true;
+	}
+
+	void RenderSnapshots::_captureEntity(core::Entity* entity)
+	{
+		// same walk as _extractEntity, so the indices line up with the next snapshot
+		if (!entity->isActive())
+		{
+			return;
+		}
+
+		captured.entities.push_back(entity->getID());
+		captured.world.push_back(entity->transform.getWorldMatrix());
+
+		for (auto* child : entity->getChildren())
+		{
+			_captureEntity(child);
+		}
+	}
+
+	auto RenderSnapshots::acquire() -> const RenderSnapshot&
+	{
+		if ((spare.load(std::memory_order_relaxed) & FreshBit) != 0)
+		{
+			front = spare.exchange(front, std::memory_order_acq_rel) & ~FreshBit;
+		}
+
+		return buffers[front];
+	}
+}
@@ -1,11 +1,13 @@
 #include "graphics/RenderThread.h"
 #include "core/Application.h"
 #include "graphics/Renderer.h"
+#include "platform/CpuTopology.h"
 
 namespace graphics
 {
 	void RenderThread::init()
 	{
+		platform::CpuTopology::applyToCurrentThread(platform::ThreadRole::Render);
 		Renderer::init();
 	}
 
@@ -2,7 +2,7 @@
 #include "utils/Demangle.h"
 #include "utils/PerformanceTimer.h"
 #include "core/Application.h"
-#include "core/Scene.h"
+#include "core/TickThread.h"
 
 namespace graphics
 {
@@ -23,11 +23,10 @@ namespace graphics
 		context->makeCurrent();
 		context->beginFrame();
 
-		for (auto* camera : core::Scene::currentScene->getCameras())
-		{
-			camera->setViewportSize(core::Application::main->getWindow()->getSize());
-			camera->render();
-		}
+		// never touch the scene from here, the tick thread is busy changing it. all the
+		// renderer gets is the last snapshot it published
+		snapshot = &RenderSnapshots::acquire();
+		alpha = core::TickThread::getAlpha();
 
 		context->endFrame();
 		context->swap();
@@ -1,9 +1,258 @@
 #include "input/Input.h"
 #include "SDL_clipboard.h"
 #include "SDL_misc.h"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
 
 namespace core
 {
+	namespace
+	{
+		std::mutex replayLock;
+
+		auto buttonIndex(uint16_t button) -> size_t
+		{
+			// sdl's buttons start at 1, same as MouseButton
+			return (size_t)button - 1;
+		}
+	}
+
+	auto Input::current() -> const InputState&
+	{
+		thread_local InputState state;
+		thread_local uint64_t version{0};
+
+		if (published.version() != version)
+		{
+			version = published.load(state);
+		}
+
+		return state;
+	}
+
+	auto Input::getKey(Scancode key) -> bool
+	{
+		auto index = (size_t)key;
+		return index < es_maxScancodes && current().keys.test(index);
+	}
+
+	auto Input::getKeyDown(Scancode key) -> bool
+	{
+		auto index = (size_t)key;
+		const auto& state = current();
+		return index < es_maxScancodes && state.keys.test(index) && !state.lastKeys.test(index);
+	}
+
+	auto Input::getKeyUp(Scancode key) -> bool
+	{
+		auto index = (size_t)key;
+		const auto& state = current();
+		return index < es_maxScancodes && !state.keys.test(index) && state.lastKeys.test(index);
+	}
+
+	auto Input::getButton(MouseButton button) -> bool
+	{
+		auto index = buttonIndex((uint16_t)button);
+		return index < es_maxMouseButtons && current().buttons.test(index);
+	}
+
+	auto Input::getButtonDown(MouseButton button) -> bool
+	{
+		auto index = buttonIndex((uint16_t)button);
+		const auto& state = current();
+		return index < es_maxMouseButtons && state.buttons.test(index) &&
+			   !state.lastButtons.test(index);
+	}
+
+	auto Input::getButtonUp(MouseButton button) -> bool
+	{
+		auto index = buttonIndex((uint16_t)button);
+		const auto& state = current();
+		return index < es_maxMouseButtons && !state.buttons.test(index) &&
+			   state.lastButtons.test(index);
+	}
+
+	auto Input::getMousePos() -> math::Vector2
+	{
+		const auto& state = current();
+		return {state.mouseX, state.mouseY};
+	}
+
+	auto Input::getMouseDelta() -> math::Vector2
+	{
+		const auto& state = current();
+		return {state.mouseDeltaX, state.mouseDeltaY};
+	}
+
+	auto Input::getMouseWheel() -> math::Vector2
+	{
+		const auto& state = current();
+		return {state.wheelX, state.wheelY};
+	}
+
+	auto Input::getState() -> InputState
+	{
+		return current();
+	}
+
+	auto Input::getHistory(uint64_t sequence, std::vector<InputRecord>& records) -> uint64_t
+	{
+		uint64_t end = historyWritten.load(std::memory_order_acquire);
+		uint64_t begin = std::max(sequence, end > HistorySize ? end - HistorySize : 0);
+
+		size_t first = records.size();
+		for (uint64_t i = begin; i < end; i++)
+		{
+			InputRecord record;
+			history[i % HistorySize].load(record);
+			records.push_back(record);
+		}
+
+		// the tick thread may have lapped the oldest few while we were copying (the
+		// slot it's writing right now included), those can't be trusted
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t after = historyWritten.load(std::memory_order_relaxed) + 1;
+		uint64_t overwritten = after > HistorySize ? after - HistorySize : 0;
+		if (overwritten > begin)
+		{
+			size_t lost = (size_t)std::min(overwritten - begin, end - begin);
+			records.erase(records.begin() + (std::ptrdiff_t)first,
+						  records.begin() + (std::ptrdiff_t)(first + lost));
+		}
+
+		return end;
+	}
+
+	void Input::replay(std::vector<InputRecord> records)
+	{
+		std::lock_guard<std::mutex> lock(replayLock);
+		replayRecords = std::move(records);
+		replayPending.store(true, std::memory_order_release);
+	}
+
+	void Input::stopReplay()
+	{
+		replay({});
+	}
+
+	void Input::advance(const std::vector<InputEvent>& events)
+	{
+		if (replayPending.load(std::memory_order_acquire))
+		{
+			std::lock_guard<std::mutex> lock(replayLock);
+			replayQueue = std::move(replayRecords);
+			replayRecords.clear();
+			replayPending.store(false, std::memory_order_relaxed);
+			replayPosition = 0;
+
+			if (!replayQueue.empty())
+			{
+				// same starting point as a fresh recording, nothing held down
+				working.keys.reset();
+				working.buttons.reset();
+				replayOffset = (int64_t)(working.tick + 1) - (int64_t)replayQueue.front().tick;
+			}
+
+			replaying.store(!replayQueue.empty(), std::memory_order_release);
+		}
+
+		working.lastKeys = working.keys;
+		working.lastButtons = working.buttons;
+		working.mouseDeltaX = 0;
+		working.mouseDeltaY = 0;
+		working.wheelX = 0;
+		working.wheelY = 0;
+		working.tick++;
+
+		const auto* source = &events;
+		if (replaying.load(std::memory_order_relaxed))
+		{
+			replayEvents.clear();
+			while (replayPosition < replayQueue.size() &&
+				   (int64_t)replayQueue[replayPosition].tick + replayOffset <=
+					   (int64_t)working.tick)
+			{
+				replayEvents.push_back(replayQueue[replayPosition++].event);
+			}
+
+			if (replayPosition == replayQueue.size())
+			{
+				replaying.store(false, std::memory_order_release);
+			}
+
+			source = &replayEvents;
+		}
+
+		for (const auto& event : *source)
+		{
+			apply(event);
+			record(event);
+		}
+
+		working.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+						   std::chrono::steady_clock::now().time_since_epoch())
+						   .count();
+		published.store(working);
+	}
+
+	void Input::apply(const InputEvent& event)
+	{
+		switch (event.type)
+		{
+		case InputEventType::KeyDown:
+		case InputEventType::KeyUp:
+			if (event.code < es_maxScancodes)
+			{
+				working.keys.set(event.code, event.type == InputEventType::KeyDown);
+			}
+			break;
+
+		case InputEventType::MouseMotion:
+			working.mouseX = (float)event.x;
+			working.mouseY = (float)event.y;
+			working.mouseDeltaX += (float)event.dx;
+			working.mouseDeltaY += (float)event.dy;
+			break;
+
+		case InputEventType::MouseButtonDown:
+		case InputEventType::MouseButtonUp:
+		{
+			auto index = buttonIndex(event.code);
+			if (index < es_maxMouseButtons)
+			{
+				working.buttons.set(index, event.type == InputEventType::MouseButtonDown);
+			}
+
+			working.mouseX = (float)event.x;
+			working.mouseY = (float)event.y;
+			break;
+		}
+
+		case InputEventType::MouseWheel:
+			working.wheelX += (float)event.x;
+			working.wheelY += (float)event.y;
+			break;
+
+		case InputEventType::FocusLost:
+			// the key ups are going to some other window now
+			working.keys.reset();
+			working.buttons.reset();
+			break;
+
+		default:
+			// controllers only end up in the history for now
+			break;
+		}
+	}
+
+	void Input::record(const InputEvent& event)
+	{
+		uint64_t index = historyWritten.load(std::memory_order_relaxed);
+		history[index % HistorySize].store({working.tick, event});
+		historyWritten.store(index + 1, std::memory_order_release);
+	}
+
 	void Input::setClipboard(const std::string& string)
     {
         SDL_SetClipboardText(string.c_str());
@@ -18,4 +267,4 @@ namespace core
     {
         SDL_OpenURL(url.c_str());
     }
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #include "platform/AssetManager.h"
+#include "core/jobs/JobManager.h"
 #include "core/log.h"
-#include "platform/JobScheduler.h"
+#include "platform/AsyncIO.h"
 #include "utils/PerformanceTimer.h"
 #include <filesystem>
 #include <mutex>
@@ -168,113 +169,267 @@ namespace core
 
 	auto AssetManager::getAsset(const std::string& path) -> std::shared_ptr<Asset>
 	{
-		auto it = assetIndex.find(path);
-		if (it == assetIndex.end())
+		const AssetEntry* entry = nullptr;
+
 		{
-			log_error("asset %s not found", path.c_str());
-			return {};
-		}
+			std::lock_guard<std::mutex> lock(mutex);
 
-		const AssetEntry& entry = it->second;
+			// loaded, or the default standing in for a read that's still going
+			if (auto loaded = loadedAssets.find(path); loaded != loadedAssets.end())
+			{
+				return loaded->second;
+			}
 
-		if (entry.bundlePath.rfind(':', 0) == 0)
-		{
-			return {readExternalData(entry)};
+			auto it = assetIndex.find(path);
+			if (it == assetIndex.end())
+			{
+				log_error("asset %s not found", path.c_str());
+				return {};
+			}
+
+			entry = &it->second;
 		}
 
-		return {readAssetData(entry)};
+		return loadAsset(*entry);
 	}
 
-	auto AssetManager::readAssetData(const AssetEntry& entry) -> std::shared_ptr<Asset>
+	void AssetManager::whenLoaded(const std::string& path, LoadCallback callback)
 	{
-		std::lock_guard<std::mutex> lock(mutex);
+		auto asset = getAsset(path);
 
-		std::ifstream file(entry.bundlePath, std::ios::binary);
-		if (!file)
 		{
-			log_error("failed to open bundle %s", entry.bundlePath.c_str());
-			return nullptr;
+			std::lock_guard<std::mutex> lock(mutex);
+			if (auto pending = pendingAssets.find(path); pending != pendingAssets.end())
+			{
+				pending->second.push_back(std::move(callback));
+				return;
+			}
 		}
 
-		file.seekg(entry.offset);
-		char* buffer = new char[entry.uncompressedSize];
+		callback(asset);
+	}
 
-		// replace this with decompression code
-		if (!file.read(buffer, entry.uncompressedSize))
-		{
-			log_error("failed to read asset %s", entry.path);
-			return nullptr;
-		}
+	void AssetManager::preload(const std::vector<std::string>& paths,
+							   jobs::JobCounter* counter)
+	{
+		es_stopwatch();
 
-		for (auto& loader : processors)
+		std::vector<platform::ReadRequest> requests;
+		requests.reserve(paths.size());
+
+		for (const auto& path : paths)
 		{
-			if (!loader->canLoad(std::filesystem::path(entry.path).extension()))
+			const AssetEntry* found = nullptr;
 			{
-				continue;
+				std::lock_guard<std::mutex> lock(mutex);
+				auto it = assetIndex.find(path);
+				if (it == assetIndex.end())
+				{
+					log_error("asset %s not found", path.c_str());
+					continue;
+				}
+
+				found = &it->second;
 			}
 
-			if (entry.uncompressedSize >= 32768 || loader->deferredLoad())
+			const AssetEntry& entry = *found;
+			auto* loader = getProcessor(entry);
+			auto file = openAssetFile(entry);
+			if (loader == nullptr || file == platform::InvalidFileHandle)
 			{
-				loadedAssets[entry.path] = loader->getDefaultAsset();
-				::internals::JobScheduler::submit(
-					[=]() { loader->load(buffer, entry.uncompressedSize); });
+				continue;
 			}
-			else
+
 			{
-				loadedAssets[entry.path] = loader->load(buffer, entry.uncompressedSize);
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!beginLoad(entry, loader))
+				{
+					// somebody else is already reading it, the counter waits for them
+					auto pending = pendingAssets.find(path);
+					if (pending != pendingAssets.end() && counter != nullptr)
+					{
+						counter->add(1);
+						pending->second.push_back([counter](const std::shared_ptr<Asset>&)
+												  { counter->decrement(); });
+					}
+					continue;
+				}
 			}
-			return {loadedAssets[entry.path]};
+
+			requests.push_back(makeRequest(entry, loader, file));
+			requests.back().counter = counter;
 		}
 
-		return nullptr;
+		// one call for everything, so reads out of the same bundle get batched together
+		platform::AsyncIO::read(requests);
 	}
 
-	auto AssetManager::readExternalData(const AssetEntry& entry) -> std::shared_ptr<Asset>
+#ifdef ES_COROUTINES
+	auto AssetManager::loadAsync(std::string path) -> jobs::Task<std::shared_ptr<Asset>>
 	{
+		jobs::JobCounter loaded;
+		preload({path}, &loaded);
+		co_await loaded;
+
 		std::lock_guard<std::mutex> lock(mutex);
-		auto bundlePath = entry.bundlePath;
+		auto it = loadedAssets.find(path);
+		co_return it != loadedAssets.end() ? it->second : nullptr;
+	}
+#endif
 
-		std::ifstream file(
-			(std::filesystem::path(bundlePath.substr(1)) / entry.path).string(),
-			std::ios::binary);
+	auto AssetManager::getProcessor(const AssetEntry& entry) -> AssetProcessor*
+	{
+		std::lock_guard<std::mutex> lock(mutex);
 
-		if (!file)
+		auto extension = std::filesystem::path(entry.path).extension();
+		for (auto& loader : processors)
 		{
-			log_error("failed to open asset %s",
-					  (std::filesystem::path(bundlePath.substr(1)) / entry.path).c_str());
-			return nullptr;
+			if (loader->canLoad(extension))
+			{
+				return loader;
+			}
 		}
 
-		char* buffer = new char[entry.uncompressedSize];
+		return nullptr;
+	}
 
-		if (!file.read(buffer, entry.uncompressedSize))
+	auto AssetManager::openAssetFile(const AssetEntry& entry) -> platform::FileHandle
+	{
+		if (entry.bundlePath.rfind(':', 0) == 0)
 		{
-			log_error("failed to read asset %s", entry.path);
-			return nullptr;
+			return platform::AsyncIO::openFile(
+				(std::filesystem::path(entry.bundlePath.substr(1)) / entry.path).string());
 		}
 
-		for (auto& loader : processors)
+		return platform::AsyncIO::openFile(entry.bundlePath);
+	}
+
+	auto AssetManager::makeRequest(const AssetEntry& entry, AssetProcessor* loader,
+								   platform::FileHandle file) -> platform::ReadRequest
+	{
+		// external files start at 0, bundled ones wherever the index says
+		bool external = entry.bundlePath.rfind(':', 0) == 0;
+
+		platform::ReadRequest request;
+		request.file = file;
+		request.offset = external ? 0 : entry.offset;
+		request.size = entry.uncompressedSize;
+		request.priority = jobs::JobPriority::Background;
+
+		// owned by the callback, so it's gone with it even if it never gets to run
+		std::shared_ptr<char[]> data(new char[entry.uncompressedSize]);
+		request.buffer = data.get();
+
+		std::string path = entry.path;
+		uint64_t size = entry.uncompressedSize;
+
+		request.onComplete = [loader, path, size, data](int64_t bytes)
 		{
-			if (!loader->canLoad(std::filesystem::path(entry.path).extension()))
+			// replace this with decompression code
+			if (bytes != (int64_t)size)
 			{
-				continue;
+				log_error("failed to read asset %s", path.c_str());
 			}
 
-			if (entry.uncompressedSize >= 32768 || loader->deferredLoad())
+			finishLoad(path, bytes == (int64_t)size ? loader->load(data.get(), size) : nullptr);
+		};
+
+		return request;
+	}
+
+	auto AssetManager::beginLoad(const AssetEntry& entry, AssetProcessor* loader) -> bool
+	{
+		if (loadedAssets.find(entry.path) != loadedAssets.end())
+		{
+			return false;
+		}
+
+		loadedAssets[entry.path] = loader->getDefaultAsset();
+		pendingAssets[entry.path];
+		return true;
+	}
+
+	void AssetManager::finishLoad(const std::string& path, const std::shared_ptr<Asset>& asset)
+	{
+		std::vector<LoadCallback> callbacks;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			// a failed read doesn't leave the default behind, the next getAsset tries again
+			if (asset != nullptr)
 			{
-				loadedAssets[entry.path] = loader->getDefaultAsset();
-				::internals::JobScheduler::submit(
-					[=]() { loader->load(buffer, entry.uncompressedSize); });
+				loadedAssets[path] = asset;
 			}
 			else
 			{
-				loadedAssets[entry.path] = loader->load(buffer, entry.uncompressedSize);
+				loadedAssets.erase(path);
 			}
 
-			return {loadedAssets[entry.path]};
+			if (auto pending = pendingAssets.find(path); pending != pendingAssets.end())
+			{
+				callbacks = std::move(pending->second);
+				pendingAssets.erase(pending);
+			}
 		}
 
-		return nullptr;
+		for (auto& callback : callbacks)
+		{
+			callback(asset);
+		}
+	}
+
+	auto AssetManager::loadAsset(const AssetEntry& entry) -> std::shared_ptr<Asset>
+	{
+		auto* loader = getProcessor(entry);
+		if (loader == nullptr)
+		{
+			return nullptr;
+		}
+
+		auto file = openAssetFile(entry);
+		if (file == platform::InvalidFileHandle)
+		{
+			return nullptr;
+		}
+
+		if (entry.uncompressedSize >= 32768 || loader->deferredLoad())
+		{
+			std::shared_ptr<Asset> asset;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				bool started = beginLoad(entry, loader);
+				asset = loadedAssets[entry.path];
+
+				// lost the race against another getAsset, theirs is already reading it
+				if (!started)
+				{
+					return asset;
+				}
+			}
+
+			platform::AsyncIO::read(makeRequest(entry, loader, file));
+			return asset;
+		}
+
+		// small enough to just read in place
+		bool external = entry.bundlePath.rfind(':', 0) == 0;
+		std::unique_ptr<char[]> buffer(new char[entry.uncompressedSize]);
+
+		auto bytes = platform::AsyncIO::readNow(file, external ? 0 : entry.offset,
+												entry.uncompressedSize, buffer.get());
+		if (bytes != (int64_t)entry.uncompressedSize)
+		{
+			log_error("failed to read asset %s", entry.path);
+			return nullptr;
+		}
+
+		auto asset = loader->load(buffer.get(), entry.uncompressedSize);
+
+		// if another thread loaded it in the meantime, everyone sticks with theirs
+		std::lock_guard<std::mutex> lock(mutex);
+		return loadedAssets.emplace(entry.path, asset).first->second;
 	}
 
 	auto AssetManager::assetExists(const std::string& path) -> bool
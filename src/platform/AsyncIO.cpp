@@ -0,0 +1,620 @@
+#include "platform/AsyncIO.h"
+#include "core/jobs/JobManager.h"
+#include "core/log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32)
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/uio.h>
+#	include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#	include <linux/io_uring.h>
+#	include <sys/mman.h>
+#	include <sys/syscall.h>
+#	define ES_IO_URING 1
+#endif
+
+namespace platform
+{
+	namespace
+	{
+		// the kernel turns down a readv with more iovecs than IOV_MAX (1024 on linux)
+		constexpr size_t MaxGroupRequests = 1024;
+
+		// past this, one huge read holding everything up isn't worth the syscalls saved
+		constexpr uint64_t MaxGroupBytes = (uint64_t)16 * 1024 * 1024;
+	}
+
+	struct AsyncIO::ReadGroup
+	{
+		FileHandle file{InvalidFileHandle};
+		uint64_t offset{0};
+		uint64_t size{0};
+
+		// how much of the group was already read when it falls back to the blocking lane
+		uint64_t done{0};
+
+		std::vector<ReadRequest> requests;
+#if !defined(_WIN32)
+		std::vector<iovec> iov;
+#endif
+	};
+
+#if defined(ES_IO_URING)
+	namespace
+	{
+		auto ioUringSetup(uint32_t entries, io_uring_params* params) -> int
+		{
+			return (int)syscall(__NR_io_uring_setup, entries, params);
+		}
+
+		auto ioUringEnter(int fd, uint32_t submit, uint32_t minComplete, uint32_t flags)
+			-> int
+		{
+			return (int)syscall(__NR_io_uring_enter, fd, submit, minComplete, flags,
+								nullptr, 0);
+		}
+
+		// user_data of the nop that wakes the completion thread up on shutdown
+		constexpr uint64_t WakeupTag = 0;
+
+		std::atomic<uint32_t> inFlight{0};
+	}
+#endif
+
+	void AsyncIO::initialize()
+	{
+		stopping = false;
+
+#if defined(ES_IO_URING)
+		if (!setupRing(256))
+		{
+			log_info("io_uring isn't available, async reads go through the job system");
+			return;
+		}
+
+		completionThread = std::thread(&AsyncIO::reapCompletions);
+		log_info("async io running on io_uring (%d entries)", ring.entries);
+#else
+		log_info("async reads go through the job system");
+#endif
+	}
+
+	void AsyncIO::shutdown()
+	{
+		stopping = true;
+
+#if defined(ES_IO_URING)
+		if (usingIoUring())
+		{
+			// the completion thread sits in io_uring_enter, give it something to wake up to
+			{
+				std::lock_guard<std::mutex> lock(submitMutex);
+				std::vector<ReadGroup*> wakeup{nullptr};
+				submitGroups(wakeup);
+			}
+
+			if (completionThread.joinable())
+			{
+				completionThread.join();
+			}
+
+			destroyRing();
+		}
+#endif
+
+		// fallback reads (io_uring retries too) still queued or running on the blocking
+		// lane read from these files, they have to be done before the fds go away
+		while (pendingGroups.load() != 0)
+		{
+			std::this_thread::yield();
+		}
+
+		closeFiles();
+	}
+
+	auto AsyncIO::openFile(const std::string& path) -> FileHandle
+	{
+		std::lock_guard<std::mutex> lock(filesMutex);
+
+		if (auto it = files.find(path); it != files.end())
+		{
+			return it->second;
+		}
+
+#if defined(_WIN32)
+		HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+									OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		auto file = handle == INVALID_HANDLE_VALUE ? InvalidFileHandle : (FileHandle)handle;
+#else
+		auto file = (FileHandle)::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+
+		if (file == InvalidFileHandle)
+		{
+			log_error("failed to open %s", path.c_str());
+			return InvalidFileHandle;
+		}
+
+		files[path] = file;
+		return file;
+	}
+
+	void AsyncIO::closeFiles()
+	{
+		std::lock_guard<std::mutex> lock(filesMutex);
+
+		for (auto& [path, file] : files)
+		{
+#if defined(_WIN32)
+			CloseHandle((HANDLE)file);
+#else
+			::close((int)file);
+#endif
+		}
+
+		files.clear();
+	}
+
+	auto AsyncIO::readNow(FileHandle file, uint64_t offset, uint64_t size, char* buffer)
+		-> int64_t
+	{
+		uint64_t total = 0;
+
+		// only stops early on eof (or an error)
+		while (total < size)
+		{
+#if defined(_WIN32)
+			OVERLAPPED overlapped{};
+			overlapped.Offset = (DWORD)(offset + total);
+			overlapped.OffsetHigh = (DWORD)((offset + total) >> 32);
+
+			DWORD chunk = (DWORD)std::min<uint64_t>(size - total, 1U << 30);
+			DWORD bytes = 0;
+			if (ReadFile((HANDLE)file, buffer + total, chunk, &bytes, &overlapped) == 0)
+			{
+				return GetLastError() == ERROR_HANDLE_EOF ? (int64_t)total : -EIO;
+			}
+#else
+			auto bytes = ::pread((int)file, buffer + total, size - total,
+								 (off_t)(offset + total));
+			if (bytes < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return -errno;
+			}
+#endif
+
+			if (bytes == 0)
+			{
+				break;
+			}
+
+			total += bytes;
+		}
+
+		return (int64_t)total;
+	}
+
+	void AsyncIO::read(ReadRequest request)
+	{
+		std::vector<ReadRequest> requests;
+		requests.push_back(std::move(request));
+		read(requests);
+	}
+
+	void AsyncIO::read(std::vector<ReadRequest>& requests)
+	{
+		if (requests.empty())
+		{
+			return;
+		}
+
+		// counted while we're in here, so shutdown can't close the files under us. it
+		// sets stopping before it looks, so one of us always sees the other
+		pendingGroups.fetch_add(1);
+		bool cancelled = stopping.load();
+
+		// nearby reads in the same file end up next to each other (and in order) so
+		// they can be merged, and the disk sees one sweep per bundle
+		std::sort(requests.begin(), requests.end(),
+				  [](const ReadRequest& a, const ReadRequest& b)
+				  {
+					  return a.file != b.file ? a.file < b.file : a.offset < b.offset;
+				  });
+
+		std::vector<ReadGroup*> groups;
+		for (auto& request : requests)
+		{
+			if (request.counter != nullptr)
+			{
+				request.counter->add(1);
+			}
+
+			if (request.file == InvalidFileHandle || cancelled)
+			{
+				auto group = new ReadGroup();
+				group->requests.push_back(std::move(request));
+				completeGroup(group, cancelled ? -ECANCELED : -EBADF);
+				continue;
+			}
+
+			auto* last = groups.empty() ? nullptr : groups.back();
+			if (last == nullptr || last->file != request.file ||
+				last->offset + last->size != request.offset ||
+				last->requests.size() == MaxGroupRequests ||
+				last->size + request.size > MaxGroupBytes)
+			{
+				last = new ReadGroup();
+				last->file = request.file;
+				last->offset = request.offset;
+				groups.push_back(last);
+			}
+
+#if !defined(_WIN32)
+			last->iov.push_back({request.buffer, request.size});
+#endif
+			last->size += request.size;
+			last->requests.push_back(std::move(request));
+		}
+
+		requests.clear();
+
+		if (usingIoUring())
+		{
+			std::lock_guard<std::mutex> lock(submitMutex);
+			submitGroups(groups);
+		}
+		else
+		{
+			for (auto* group : groups)
+			{
+				submitGroupJob(group);
+			}
+		}
+
+		pendingGroups.fetch_sub(1);
+	}
+
+	void AsyncIO::submitGroupJob(ReadGroup* group)
+	{
+		pendingGroups.fetch_add(1);
+
+		auto handle = core::jobs::JobManager::createBlockingJob(&AsyncIO::runGroup, group);
+		core::jobs::JobManager::setCleanup(handle, &AsyncIO::cancelGroup);
+
+		if (!core::jobs::JobManager::submitJob(handle).isValid())
+		{
+			completeGroup(group, -ECANCELED);
+			pendingGroups.fetch_sub(1);
+		}
+	}
+
+	void AsyncIO::cancelGroup(void* data)
+	{
+		completeGroup(static_cast<ReadGroup*>(data), -ECANCELED);
+		pendingGroups.fetch_sub(1);
+	}
+
+	void AsyncIO::runGroup(core::jobs::Job* /*job*/, void* data)
+	{
+		auto* group = static_cast<ReadGroup*>(data);
+
+		// read each request on its own (the start of the group might already be there
+		// if io_uring came back short), then hand out the results
+		uint64_t position = group->offset;
+		for (auto& request : group->requests)
+		{
+			uint64_t skip = 0;
+			if (group->offset + group->done > position)
+			{
+				skip = std::min(group->offset + group->done - position, request.size);
+			}
+
+			int64_t result = (int64_t)request.size;
+			if (skip < request.size)
+			{
+				result = readNow(request.file, request.offset + skip, request.size - skip,
+								 request.buffer + skip);
+				if (result >= 0)
+				{
+					result += (int64_t)skip;
+				}
+			}
+
+			position += request.size;
+
+			auto single = new ReadGroup();
+			single->requests.push_back(std::move(request));
+			completeGroup(single, result);
+		}
+
+		delete group;
+		pendingGroups.fetch_sub(1);
+	}
+
+	void AsyncIO::completeGroup(ReadGroup* group, int64_t result)
+	{
+		uint64_t position = 0;
+		for (auto& request : group->requests)
+		{
+			// a merged read that came back whole covers every request in it
+			int64_t bytes = result;
+			if (result >= 0 && group->requests.size() > 1)
+			{
+				bytes = (int64_t)std::min<uint64_t>(
+					request.size, (uint64_t)result > position ? result - position : 0);
+			}
+			position += request.size;
+
+			auto* counter = request.counter;
+			auto handle = core::jobs::JobManager::submitTask(
+				[callback = request.onComplete, bytes]()
+				{
+					if (callback)
+					{
+						callback(bytes);
+					}
+				},
+				request.priority, counter);
+
+			// the job system is shutting down, the callback still has to hear about it
+			if (!handle.isValid() && request.onComplete)
+			{
+				request.onComplete(bytes);
+			}
+
+			if (counter != nullptr)
+			{
+				counter->decrement();
+			}
+		}
+
+		delete group;
+	}
+
+#if defined(ES_IO_URING)
+	auto AsyncIO::setupRing(uint32_t entries) -> bool
+	{
+		io_uring_params params{};
+		int fd = ioUringSetup(entries, &params);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		// older kernels map the sq and cq rings separately
+		ring.sqMemorySize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		ring.cqMemorySize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (singleMap)
+		{
+			ring.sqMemorySize = ring.cqMemorySize =
+				std::max(ring.sqMemorySize, ring.cqMemorySize);
+		}
+
+		ring.sqMemory = mmap(nullptr, ring.sqMemorySize, PROT_READ | PROT_WRITE,
+							 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+		ring.cqMemory = singleMap ? ring.sqMemory
+								  : mmap(nullptr, ring.cqMemorySize, PROT_READ | PROT_WRITE,
+										 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		ring.sqeMemorySize = params.sq_entries * sizeof(io_uring_sqe);
+		ring.sqeMemory = mmap(nullptr, ring.sqeMemorySize, PROT_READ | PROT_WRITE,
+							  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+		ring.fd = fd;
+		if (ring.sqMemory == MAP_FAILED || ring.cqMemory == MAP_FAILED ||
+			ring.sqeMemory == MAP_FAILED)
+		{
+			log_warn("failed to map the io_uring rings");
+			destroyRing();
+			return false;
+		}
+
+		auto* sq = static_cast<char*>(ring.sqMemory);
+		auto* cq = static_cast<char*>(ring.cqMemory);
+
+		ring.entries = params.sq_entries;
+		ring.sqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+		ring.sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+		ring.sqMask = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+		ring.sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+		ring.cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+		ring.cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+		ring.cqMask = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+		ring.cqes = cq + params.cq_off.cqes;
+		ring.sqes = ring.sqeMemory;
+
+		return true;
+	}
+
+	void AsyncIO::destroyRing()
+	{
+		if (ring.sqeMemory != nullptr && ring.sqeMemory != MAP_FAILED)
+		{
+			munmap(ring.sqeMemory, ring.sqeMemorySize);
+		}
+
+		if (ring.cqMemory != nullptr && ring.cqMemory != MAP_FAILED &&
+			ring.cqMemory != ring.sqMemory)
+		{
+			munmap(ring.cqMemory, ring.cqMemorySize);
+		}
+
+		if (ring.sqMemory != nullptr && ring.sqMemory != MAP_FAILED)
+		{
+			munmap(ring.sqMemory, ring.sqMemorySize);
+		}
+
+		if (ring.fd >= 0)
+		{
+			::close(ring.fd);
+		}
+
+		ring = IoRing();
+	}
+
+	// expects submitMutex to be held. a null group is a nop for the completion thread
+	void AsyncIO::submitGroups(std::vector<ReadGroup*>& groups)
+	{
+		auto* sqes = static_cast<io_uring_sqe*>(ring.sqes);
+		uint32_t pending = 0;
+
+		auto flush = [&]()
+		{
+			while (pending != 0)
+			{
+				int submitted = ioUringEnter(ring.fd, pending, 0, 0);
+				if (submitted < 0)
+				{
+					if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+					{
+						// completion queue is backed up, let the reaper catch up
+						std::this_thread::yield();
+						continue;
+					}
+
+					// the kernel never saw what's left, so take it back off the ring and
+					// fail it here, otherwise nobody would ever complete those groups
+					int error = errno;
+					log_error("io_uring_enter failed (%s)", strerror(error));
+
+					uint32_t head = __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE);
+					uint32_t tail = *ring.sqTail;
+					__atomic_store_n(ring.sqTail, head, __ATOMIC_RELEASE);
+
+					for (; head != tail; head++)
+					{
+						auto& sqe = sqes[ring.sqArray[head & *ring.sqMask]];
+						auto* group = reinterpret_cast<ReadGroup*>((uintptr_t)sqe.user_data);
+						if (group != nullptr)
+						{
+							inFlight.fetch_sub(1, std::memory_order_acq_rel);
+							completeGroup(group, -error);
+						}
+					}
+
+					pending = 0;
+					return;
+				}
+
+				pending -= std::min<uint32_t>(pending, (uint32_t)submitted);
+			}
+		};
+
+		for (auto* group : groups)
+		{
+			uint32_t tail = *ring.sqTail;
+			if (tail - __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE) >= ring.entries)
+			{
+				// without sqpoll the kernel eats everything on enter, so this frees it all
+				flush();
+				tail = *ring.sqTail;
+			}
+
+			uint32_t index = tail & *ring.sqMask;
+			io_uring_sqe* sqe = &sqes[index];
+			memset(sqe, 0, sizeof(*sqe));
+
+			if (group == nullptr)
+			{
+				sqe->opcode = IORING_OP_NOP;
+				sqe->user_data = WakeupTag;
+			}
+			else
+			{
+				sqe->opcode = IORING_OP_READV;
+				sqe->fd = (int)group->file;
+				sqe->off = group->offset;
+				sqe->addr = (uint64_t)(uintptr_t)group->iov.data();
+				sqe->len = (uint32_t)group->iov.size();
+				sqe->user_data = (uint64_t)(uintptr_t)group;
+				inFlight.fetch_add(1, std::memory_order_release);
+			}
+
+			ring.sqArray[index] = index;
+			__atomic_store_n(ring.sqTail, tail + 1, __ATOMIC_RELEASE);
+			pending++;
+		}
+
+		flush();
+	}
+
+	void AsyncIO::reapCompletions()
+	{
+		auto* cqes = static_cast<io_uring_cqe*>(ring.cqes);
+
+		while (true)
+		{
+			uint32_t head = *ring.cqHead;
+			uint32_t tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+
+			if (head == tail)
+			{
+				if (stopping && inFlight.load(std::memory_order_relaxed) == 0)
+				{
+					return;
+				}
+
+				if (ioUringEnter(ring.fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+					errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				{
+					log_error("io_uring_enter failed (%s)", strerror(errno));
+					return;
+				}
+				continue;
+			}
+
+			while (head != tail)
+			{
+				io_uring_cqe& cqe = cqes[head & *ring.cqMask];
+				auto* group = reinterpret_cast<ReadGroup*>((uintptr_t)cqe.user_data);
+				int64_t result = cqe.res;
+				head++;
+
+				if (group == nullptr)
+				{
+					continue;
+				}
+
+				// pairs with the add on submit. the kernel orders this already, but
+				// this way the group is visibly handed over (tsan can't see the ring)
+				inFlight.fetch_sub(1, std::memory_order_acq_rel);
+
+				// short read, could just be eof but could also be the kernel giving up
+				// halfway. let the blocking lane figure out the rest
+				if (result >= 0 && (uint64_t)result < group->size)
+				{
+					group->done = (uint64_t)result;
+					submitGroupJob(group);
+					continue;
+				}
+
+				completeGroup(group, result);
+			}
+
+			__atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+		}
+	}
+#else
+	auto AsyncIO::setupRing(uint32_t /*entries*/) -> bool
+	{
+		return false;
+	}
+
+	void AsyncIO::destroyRing() {}
+
+	void AsyncIO::submitGroups(std::vector<ReadGroup*>& /*groups*/) {}
+
+	void AsyncIO::reapCompletions() {}
+#endif
+}
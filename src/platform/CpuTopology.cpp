@@ -0,0 +1,417 @@
+#include "platform/CpuTopology.h"
+#include "core/log.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+
+#if defined(__linux__)
+#	include <pthread.h>
+#	include <sched.h>
+#endif
+
+namespace platform
+{
+	namespace
+	{
+		// "0-3,8,10-11" -> 0 1 2 3 8 10 11
+		auto parseCpuList(const std::string& text) -> std::vector<uint32_t>
+		{
+			std::vector<uint32_t> cpus;
+			size_t position = 0;
+
+			while (position < text.size())
+			{
+				size_t end = text.find(',', position);
+				if (end == std::string::npos)
+				{
+					end = text.size();
+				}
+
+				auto range = text.substr(position, end - position);
+				position = end + 1;
+
+				if (range.empty() || !isdigit((unsigned char)range[0]))
+				{
+					continue;
+				}
+
+				auto dash = range.find('-');
+				uint32_t first = std::stoul(range.substr(0, dash));
+				uint32_t last =
+					dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+
+				for (uint32_t cpu = first; cpu <= last; cpu++)
+				{
+					cpus.push_back(cpu);
+				}
+			}
+
+			return cpus;
+		}
+
+		auto readLine(const std::string& path) -> std::string
+		{
+			std::ifstream file(path);
+			std::string line;
+			std::getline(file, line);
+			return line;
+		}
+
+		auto readNumber(const std::string& path, uint32_t fallback) -> uint32_t
+		{
+			auto line = readLine(path);
+			if (line.empty() || !isdigit((unsigned char)line[0]))
+			{
+				return fallback;
+			}
+
+			return std::stoul(line);
+		}
+
+		auto allCpus(const std::vector<const PhysicalCore*>& slice) -> std::vector<uint32_t>
+		{
+			std::vector<uint32_t> cpus;
+			for (const auto* core : slice)
+			{
+				cpus.insert(cpus.end(), core->cpus.begin(), core->cpus.end());
+			}
+
+			std::sort(cpus.begin(), cpus.end());
+			return cpus;
+		}
+	}
+
+	auto CpuLayout::smtWidth() const -> uint32_t
+	{
+		size_t width = 1;
+		for (const auto& core : cores)
+		{
+			width = std::max(width, core.cpus.size());
+		}
+
+		return (uint32_t)width;
+	}
+
+	auto CpuTopology::getLayout() -> const CpuLayout&
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!detected)
+		{
+			layout = detect();
+			detected = true;
+		}
+
+		return layout;
+	}
+
+	void CpuTopology::setPolicy(const PlacementPolicy& newPolicy)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		policy = newPolicy;
+		placed = false;
+	}
+
+	auto CpuTopology::getPolicy() -> PlacementPolicy
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return policy;
+	}
+
+	auto CpuTopology::getPlacement() -> ThreadPlacement
+	{
+		const auto& cpuLayout = getLayout();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!placed)
+		{
+			placement = computePlacement(cpuLayout, policy);
+			placed = true;
+		}
+
+		return placement;
+	}
+
+	auto CpuTopology::workerCount() -> size_t
+	{
+		return std::max<size_t>(1, getPlacement().workers.size());
+	}
+
+	void CpuTopology::applyToCurrentThread(ThreadRole role, size_t index)
+	{
+		auto current = getPlacement();
+
+		switch (role)
+		{
+		case ThreadRole::Main:
+			pinCurrentThread(current.main);
+			break;
+		case ThreadRole::Render:
+			pinCurrentThread(current.render);
+			break;
+		case ThreadRole::Tick:
+			pinCurrentThread(current.tick);
+			break;
+		case ThreadRole::Worker:
+			if (!current.workers.empty())
+			{
+				pinCurrentThread(current.workers[index % current.workers.size()]);
+			}
+			break;
+		}
+	}
+
+	auto CpuTopology::describe() -> std::string
+	{
+		const auto& cpuLayout = getLayout();
+		return std::to_string(cpuLayout.cpus.size()) + " logical cpus, " +
+			   std::to_string(cpuLayout.cores.size()) + " physical cores, " +
+			   std::to_string(cpuLayout.nodes.size()) + " numa nodes";
+	}
+
+	auto CpuTopology::detect() -> CpuLayout
+	{
+		CpuLayout result;
+		std::vector<uint32_t> allowed;
+
+#if defined(__linux__)
+		const std::string root = "/sys/devices/system/cpu/";
+
+		// only what we're allowed to run on, someone might've started us under taskset
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+		{
+			for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			{
+				if (CPU_ISSET(cpu, &mask))
+				{
+					allowed.push_back(cpu);
+				}
+			}
+		}
+		else
+		{
+			allowed = parseCpuList(readLine(root + "online"));
+		}
+
+		// cpu -> numa node
+		std::map<uint32_t, uint32_t> nodeOf;
+		std::error_code error;
+		for (const auto& entry :
+			 std::filesystem::directory_iterator("/sys/devices/system/node", error))
+		{
+			auto name = entry.path().filename().string();
+			if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+				!isdigit((unsigned char)name[4]))
+			{
+				continue;
+			}
+
+			uint32_t node = std::stoul(name.substr(4));
+			for (auto cpu : parseCpuList(readLine(entry.path().string() + "/cpulist")))
+			{
+				nodeOf[cpu] = node;
+			}
+		}
+
+		// group hardware threads into cores by (package, core id)
+		std::map<std::pair<uint32_t, uint32_t>, size_t> coreOf;
+		for (auto cpu : allowed)
+		{
+			auto topology = root + "cpu" + std::to_string(cpu) + "/topology/";
+			uint32_t package = readNumber(topology + "physical_package_id", 0);
+			uint32_t coreId = readNumber(topology + "core_id", cpu);
+
+			auto key = std::make_pair(package, coreId);
+			auto it = coreOf.find(key);
+			if (it == coreOf.end())
+			{
+				PhysicalCore core;
+				core.package = package;
+				core.node = nodeOf.count(cpu) != 0 ? nodeOf[cpu] : 0;
+				it = coreOf.emplace(key, result.cores.size()).first;
+				result.cores.push_back(core);
+			}
+
+			result.cores[it->second].cpus.push_back(cpu);
+		}
+#endif
+
+		if (result.cores.empty())
+		{
+			// nothing to go on, every cpu is a core of its own
+			uint32_t count = std::max(1U, std::thread::hardware_concurrency());
+			for (uint32_t cpu = 0; cpu < count; cpu++)
+			{
+				PhysicalCore core;
+				core.cpus.push_back(cpu);
+				result.cores.push_back(core);
+			}
+		}
+
+		std::sort(result.cores.begin(), result.cores.end(),
+				  [](const PhysicalCore& a, const PhysicalCore& b)
+				  {
+					  if (a.node != b.node)
+					  {
+						  return a.node < b.node;
+					  }
+					  if (a.package != b.package)
+					  {
+						  return a.package < b.package;
+					  }
+					  return a.cpus.front() < b.cpus.front();
+				  });
+
+		for (uint32_t i = 0; i < result.cores.size(); i++)
+		{
+			auto& core = result.cores[i];
+			std::sort(core.cpus.begin(), core.cpus.end());
+
+			if (result.nodes.empty() || result.nodes.back().id != core.node)
+			{
+				result.nodes.push_back({core.node, {}});
+			}
+
+			for (uint32_t sibling = 0; sibling < core.cpus.size(); sibling++)
+			{
+				result.cpus.push_back({core.cpus[sibling], i, core.node, sibling});
+				result.nodes.back().cpus.push_back(core.cpus[sibling]);
+			}
+		}
+
+		std::sort(result.cpus.begin(), result.cpus.end(),
+				  [](const LogicalCpu& a, const LogicalCpu& b) { return a.id < b.id; });
+
+		return result;
+	}
+
+	auto CpuTopology::computePlacement(const CpuLayout& cpuLayout,
+									   const PlacementPolicy& placementPolicy)
+		-> ThreadPlacement
+	{
+		ThreadPlacement result;
+
+		// this instance's slice of the machine. cores are sorted by node, so contiguous
+		// slices don't straddle nodes unless they have to
+		const auto& cores = cpuLayout.cores;
+		uint32_t instances = std::max(1U, placementPolicy.instanceCount);
+		size_t instance = placementPolicy.instanceIndex % instances;
+		size_t begin = instance * cores.size() / instances;
+		size_t end = (instance + 1) * cores.size() / instances;
+
+		std::vector<const PhysicalCore*> slice;
+		for (size_t i = begin; i < end; i++)
+		{
+			slice.push_back(&cores[i]);
+		}
+
+		if (slice.empty())
+		{
+			// more instances than cores, share
+			slice.push_back(&cores[instance % cores.size()]);
+		}
+
+		// reserved threads get a core each, as long as at least one is left for workers
+		std::vector<std::vector<uint32_t>*> reservations;
+		if (placementPolicy.reserveMain)
+		{
+			reservations.push_back(&result.main);
+		}
+		if (placementPolicy.reserveRender)
+		{
+			reservations.push_back(&result.render);
+		}
+		if (placementPolicy.reserveTick)
+		{
+			reservations.push_back(&result.tick);
+		}
+
+		size_t firstWorkerCore = 0;
+		if (slice.size() > reservations.size())
+		{
+			for (auto* reservation : reservations)
+			{
+				*reservation = slice[firstWorkerCore++]->cpus;
+			}
+		}
+
+		std::vector<const PhysicalCore*> workerCores(slice.begin() + firstWorkerCore,
+													 slice.end());
+
+		// anything without a core of its own floats over the worker cores. it still has
+		// to be pinned, otherwise it inherits whatever the thread that spawned it had
+		auto shared = allCpus(workerCores);
+		for (auto* set : {&result.main, &result.render, &result.tick})
+		{
+			if (set->empty())
+			{
+				*set = shared;
+			}
+		}
+
+		if (placementPolicy.workers == WorkerPlacement::PerPhysicalCore)
+		{
+			for (const auto* core : workerCores)
+			{
+				result.workers.push_back(core->cpus);
+			}
+		}
+		else
+		{
+			// first siblings first, so a partial pool is still spread over every core
+			for (uint32_t sibling = 0; sibling < cpuLayout.smtWidth(); sibling++)
+			{
+				for (const auto* core : workerCores)
+				{
+					if (sibling < core->cpus.size())
+					{
+						result.workers.push_back({core->cpus[sibling]});
+					}
+				}
+			}
+		}
+
+		if (!placementPolicy.pinThreads)
+		{
+			result.main.clear();
+			result.render.clear();
+			result.tick.clear();
+			for (auto& worker : result.workers)
+			{
+				worker.clear();
+			}
+		}
+
+		return result;
+	}
+
+	auto CpuTopology::pinCurrentThread(const std::vector<uint32_t>& cpus) -> bool
+	{
+		if (cpus.empty())
+		{
+			return false;
+		}
+
+#if defined(__linux__)
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		for (auto cpu : cpus)
+		{
+			CPU_SET(cpu, &cpuset);
+		}
+
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0)
+		{
+			log_warn("failed to set thread affinity");
+			return false;
+		}
+
+		return true;
+#else
+		return false;
+#endif
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "platform/EnvironmentInfo.h"
+#include "platform/CpuTopology.h"
 #include "core/Application.h"
 #include "core/log.h"
 #include "utils/CrashReporter.h"
@@ -68,6 +69,8 @@ namespace platform
 		system.platform = getPlatform();
 		system.architecture = getArchitecture();
 		system.cpuCores = getCoreCount();
+		system.physicalCores = CpuTopology::getLayout().cores.size();
+		system.numaNodes = CpuTopology::getLayout().nodes.size();
 		system.osVersion = getOSVersion();
 		system.cpuBrand = getCPUBrand();
 		system.totalMemoryMB = getTotalMemoryMB();
@@ -18,6 +18,9 @@ namespace internals
             break;
 
 		case SDL_WINDOWEVENT:
+			core::Application::main->getWindow()->handleEvent(&e);
+			break;
+
 		case SDL_SYSWMEVENT:
 		case SDL_KEYDOWN:
 		case SDL_KEYUP:
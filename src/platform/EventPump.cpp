@@ -0,0 +1,219 @@
+#include "platform/EventPump.h"
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_events.h"
+#include "platform/EventHandler.h"
+#include <algorithm>
+
+namespace platform
+{
+	namespace
+	{
+		auto now() -> uint64_t
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+					   std::chrono::steady_clock::now().time_since_epoch())
+				.count();
+		}
+
+		// sdl hands these out in chunks, so one call covers a normal frame's worth
+		constexpr int PeepBatch = 64;
+	}
+
+	auto EventPump::pump() -> size_t
+	{
+		size_t count = drain();
+
+		auto budget = std::chrono::microseconds(frameBudget.load(std::memory_order_relaxed));
+		if (count == 0 && budget.count() > 0)
+		{
+			// the budget counts from the end of the last pump, so a loop that did some
+			// work in between doesn't get an extra frame of sleep on top
+			auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+				frameStart + budget - std::chrono::steady_clock::now());
+
+			SDL_Event event;
+			if (remaining.count() > 0 && SDL_WaitEventTimeout(&event, (int)remaining.count()) == 1)
+			{
+				translate(event, now());
+				count = 1 + drain();
+			}
+		}
+
+		publish();
+		frameStart = std::chrono::steady_clock::now();
+		return count;
+	}
+
+	void EventPump::setFrameBudget(std::chrono::microseconds budget)
+	{
+		frameBudget.store(std::max<int64_t>(0, budget.count()), std::memory_order_relaxed);
+	}
+
+	auto EventPump::getFrameBudget() -> std::chrono::microseconds
+	{
+		return std::chrono::microseconds(frameBudget.load(std::memory_order_relaxed));
+	}
+
+	void EventPump::consume(std::vector<core::InputEvent>& events)
+	{
+		events.clear();
+
+		// the vectors just trade places, so after a few frames nobody allocates
+		std::lock_guard<std::mutex> guard(lock);
+		std::swap(events, pending);
+	}
+
+	auto EventPump::drain() -> size_t
+	{
+		SDL_PumpEvents();
+
+		SDL_Event events[PeepBatch];
+		size_t count = 0;
+
+		while (true)
+		{
+			int taken = SDL_PeepEvents(events, PeepBatch, SDL_GETEVENT, SDL_FIRSTEVENT,
+									   SDL_LASTEVENT);
+			if (taken <= 0)
+			{
+				break;
+			}
+
+			// one timestamp per chunk, they all came in since the last pump anyway
+			uint64_t time = now();
+			for (int i = 0; i < taken; i++)
+			{
+				translate(events[i], time);
+			}
+
+			count += taken;
+			if (taken < PeepBatch)
+			{
+				break;
+			}
+		}
+
+		return count;
+	}
+
+	void EventPump::translate(const SDL_Event& event, uint64_t time)
+	{
+		core::InputEvent input;
+		input.time = time;
+
+		switch ((SDL_EventType)event.type)
+		{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			input.type = event.type == SDL_KEYDOWN ? core::InputEventType::KeyDown
+												   : core::InputEventType::KeyUp;
+			input.code = (uint16_t)event.key.keysym.scancode;
+			input.modifiers = event.key.keysym.mod;
+			input.repeat = event.key.repeat != 0;
+			break;
+
+		case SDL_MOUSEMOTION:
+		{
+			// nobody needs every single step of a motion burst, only where it ended up
+			// and how far it went
+			if (!batch.empty() && batch.back().type == core::InputEventType::MouseMotion)
+			{
+				auto& last = batch.back();
+				last.time = time;
+				last.x = event.motion.x;
+				last.y = event.motion.y;
+				last.dx += event.motion.xrel;
+				last.dy += event.motion.yrel;
+				return;
+			}
+
+			input.type = core::InputEventType::MouseMotion;
+			input.x = event.motion.x;
+			input.y = event.motion.y;
+			input.dx = event.motion.xrel;
+			input.dy = event.motion.yrel;
+			break;
+		}
+
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			input.type = event.type == SDL_MOUSEBUTTONDOWN ? core::InputEventType::MouseButtonDown
+														   : core::InputEventType::MouseButtonUp;
+			input.code = event.button.button;
+			input.x = event.button.x;
+			input.y = event.button.y;
+			break;
+
+		case SDL_MOUSEWHEEL:
+		{
+			int32_t flip = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -1 : 1;
+			input.type = core::InputEventType::MouseWheel;
+			input.x = event.wheel.x * flip;
+			input.y = event.wheel.y * flip;
+			break;
+		}
+
+		case SDL_CONTROLLERBUTTONDOWN:
+		case SDL_CONTROLLERBUTTONUP:
+			input.type = event.type == SDL_CONTROLLERBUTTONDOWN
+							 ? core::InputEventType::ControllerButtonDown
+							 : core::InputEventType::ControllerButtonUp;
+			input.code = event.cbutton.button;
+			input.device = (uint16_t)event.cbutton.which;
+			break;
+
+		case SDL_CONTROLLERAXISMOTION:
+			input.type = core::InputEventType::ControllerAxis;
+			input.code = event.caxis.axis;
+			input.device = (uint16_t)event.caxis.which;
+			input.x = event.caxis.value;
+			break;
+
+		case SDL_WINDOWEVENT:
+			// the window still wants to see it, this is just so keys don't stay stuck
+			if (event.window.event == SDL_WINDOWEVENT_FOCUS_LOST)
+			{
+				input.type = core::InputEventType::FocusLost;
+				batch.push_back(input);
+			}
+
+			::internals::handleEvent(event);
+			return;
+
+		default:
+			// quitting, window and app events are dealt with right here on main
+			::internals::handleEvent(event);
+			return;
+		}
+
+		batch.push_back(input);
+	}
+
+	void EventPump::publish()
+	{
+		if (batch.empty())
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> guard(lock);
+		if (pending.empty())
+		{
+			std::swap(pending, batch);
+		}
+		else
+		{
+			pending.insert(pending.end(), batch.begin(), batch.end());
+			batch.clear();
+		}
+
+		// the tick thread is stuck (or paused), keep the newest so input doesn't come
+		// back minutes late when it resumes
+		if (pending.size() > MaxPendingEvents)
+		{
+			size_t excess = pending.size() - MaxPendingEvents;
+			pending.erase(pending.begin(), pending.begin() + (std::ptrdiff_t)excess);
+			dropped.fetch_add(excess, std::memory_order_relaxed);
+		}
+	}
+}
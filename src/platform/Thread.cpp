@@ -83,12 +83,8 @@ namespace platform
 
 	void Thread::executeWorkQueue()
 	{
-		std::lock_guard<std::mutex> lock(mutex);
-		while (!workQueue.empty())
-		{
-			workQueue.front()();
-			workQueue.pop();
-		}
+		// no lock, tasks can post back into this (or any other) thread freely
+		mailbox.drain();
 	}
 
 	ThreadTime::ThreadTime()
@@ -155,9 +151,18 @@ namespace platform
 		return core::time;
 	}
 
-	void Thread::submitTask(const std::function<void()>& task)
+	void Thread::_post(InlineTask& task)
 	{
-		std::lock_guard<std::mutex> lock(mutex);
-		workQueue.push(task);
+		while (!mailbox.tryPush(task))
+		{
+			// full. waiting on ourselves would never end, so just run it here
+			if (std::this_thread::get_id() == thread.get_id())
+			{
+				task();
+				return;
+			}
+
+			std::this_thread::yield();
+		}
 	}
 }
\ No newline at end of file
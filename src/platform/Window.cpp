@@ -11,8 +11,7 @@ namespace platform
 	Window::Window(const std::string& title, int width, int height)
 	{
 		_title = title;
-		_width = width;
-		_height = height;
+		_setSize(width, height);
 	}
 
 	void Window::create()
@@ -64,7 +63,8 @@ namespace platform
 	void Window::setSize(int width, int height)
 	{
 		SDL_SetWindowSize(_window, width, height);
-		SDL_GetWindowSize(_window, &_width, &_height);
+		SDL_GetWindowSize(_window, &width, &height);
+		_setSize(width, height);
 	}
 
 	void Window::setMinSize(int width, int height)
@@ -117,14 +117,12 @@ namespace platform
 			break;
 
 		case SDL_WINDOWEVENT_RESIZED:
-			_width = sdlEvent->window.data1;
-			_height = sdlEvent->window.data2;
+			_setSize(sdlEvent->window.data1, sdlEvent->window.data2);
 			core::EventManager::triggerEvent("window.resized");
 			break;
 
 		case SDL_WINDOWEVENT_SIZE_CHANGED:
-			_width = sdlEvent->window.data1;
-			_height = sdlEvent->window.data2;
+			_setSize(sdlEvent->window.data1, sdlEvent->window.data2);
 			break;
 
 		case SDL_WINDOWEVENT_MINIMIZED:
@@ -171,9 +169,18 @@ namespace platform
 		return _vsync;
 	}
 
+	void Window::_setSize(int width, int height)
+	{
+		_width = width;
+		_height = height;
+		_publishedSize.store(((uint64_t)(uint32_t)width << 32) | (uint32_t)height,
+							 std::memory_order_release);
+	}
+
 	auto Window::getSize() const -> math::Vector2
 	{
-		return {(float)_width, (float)_height};
+		uint64_t size = _publishedSize.load(std::memory_order_acquire);
+		return {(float)(int32_t)(size >> 32), (float)(int32_t)(uint32_t)size};
 	}
 
 	auto Window::getPosition() const -> math::Vector2
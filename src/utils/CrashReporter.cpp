@@ -30,6 +30,10 @@ namespace utils
 	{
 		auto* envInfo = core::Application::main->getEnvironmentInfo();
 		auto* frameMemoryPool = core::Application::main->getFrameMemoryPool();
+		float frameMemoryMB =
+			frameMemoryPool != nullptr
+				? (float)frameMemoryPool->getBytesUsed() / (1024 * 1024)
+				: 0.F;
 
 		auto timestamp = std::time(nullptr);
 		auto* date = localtime(&timestamp);
@@ -76,15 +80,12 @@ namespace utils
 
 		crash << "Out of " << envInfo->system.totalMemoryMB << "MB of memory, "
 			  << envInfo->system.availableMemoryMB << "MB are available. Used "
-			  << ((float)frameMemoryPool->getBytesUsed() / (1024 * 1024))
-			  << "MB per frame ("
+			  << frameMemoryMB << "MB per frame ("
 			  << (1.F - ((float)envInfo->system.availableMemoryMB /
 						 (float)envInfo->system.totalMemoryMB)) *
 					 100.F
 			  << "% used, "
-			  << (((float)frameMemoryPool->getBytesUsed() / (1024 * 1024) /
-				   (float)envInfo->system.totalMemoryMB) *
-				  100.F)
+			  << ((frameMemoryMB / (float)envInfo->system.totalMemoryMB) * 100.F)
 			  << "% per frame)\n";
 
 		auto endTime = std::chrono::duration_cast<std::chrono::milliseconds>(
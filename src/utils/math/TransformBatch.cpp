@@ -0,0 +1,390 @@
+#include "utils/math/TransformBatch.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ES_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ES_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace math
+{
+	static_assert(sizeof(Matrix4) == 16 * sizeof(float), "the kernels write matrices as 16 floats");
+
+	namespace
+	{
+		// one transform at a time, for the leftovers and machines without simd
+		struct ScalarLanes
+		{
+			static constexpr size_t Width = 1;
+			float v;
+
+			static auto load(const float* p) -> ScalarLanes
+			{
+				return {*p};
+			}
+			static auto set(float value) -> ScalarLanes
+			{
+				return {value};
+			}
+			static auto sqrt(ScalarLanes a) -> ScalarLanes
+			{
+				return {std::sqrt(a.v)};
+			}
+			static auto max(ScalarLanes a, ScalarLanes b) -> ScalarLanes
+			{
+				return {std::max(a.v, b.v)};
+			}
+
+			friend auto operator+(ScalarLanes a, ScalarLanes b) -> ScalarLanes
+			{
+				return {a.v + b.v};
+			}
+			friend auto operator-(ScalarLanes a, ScalarLanes b) -> ScalarLanes
+			{
+				return {a.v - b.v};
+			}
+			friend auto operator*(ScalarLanes a, ScalarLanes b) -> ScalarLanes
+			{
+				return {a.v * b.v};
+			}
+			friend auto operator/(ScalarLanes a, ScalarLanes b) -> ScalarLanes
+			{
+				return {a.v / b.v};
+			}
+
+			static void store(const ScalarLanes (&m)[4][3], float* out)
+			{
+				for (int column = 0; column < 4; column++)
+				{
+					out[column * 4 + 0] = m[column][0].v;
+					out[column * 4 + 1] = m[column][1].v;
+					out[column * 4 + 2] = m[column][2].v;
+					out[column * 4 + 3] = column == 3 ? 1.0F : 0.0F;
+				}
+			}
+
+			static void mulParent(const float* parent, float* matrix)
+			{
+				for (int column = 0; column < 4; column++)
+				{
+					float local[4] = {matrix[column * 4 + 0], matrix[column * 4 + 1],
+									  matrix[column * 4 + 2], matrix[column * 4 + 3]};
+
+					for (int row = 0; row < 4; row++)
+					{
+						matrix[column * 4 + row] = parent[0 * 4 + row] * local[0] +
+												   parent[1 * 4 + row] * local[1] +
+												   parent[2 * 4 + row] * local[2] +
+												   parent[3 * 4 + row] * local[3];
+					}
+				}
+			}
+		};
+
+#ifdef ES_SIMD_X86
+		struct SseLanes
+		{
+			static constexpr size_t Width = 4;
+			__m128 v;
+
+			static auto load(const float* p) -> SseLanes
+			{
+				return {_mm_loadu_ps(p)};
+			}
+			static auto set(float value) -> SseLanes
+			{
+				return {_mm_set1_ps(value)};
+			}
+			static auto sqrt(SseLanes a) -> SseLanes
+			{
+				return {_mm_sqrt_ps(a.v)};
+			}
+			static auto max(SseLanes a, SseLanes b) -> SseLanes
+			{
+				return {_mm_max_ps(a.v, b.v)};
+			}
+
+			friend auto operator+(SseLanes a, SseLanes b) -> SseLanes
+			{
+				return {_mm_add_ps(a.v, b.v)};
+			}
+			friend auto operator-(SseLanes a, SseLanes b) -> SseLanes
+			{
+				return {_mm_sub_ps(a.v, b.v)};
+			}
+			friend auto operator*(SseLanes a, SseLanes b) -> SseLanes
+			{
+				return {_mm_mul_ps(a.v, b.v)};
+			}
+			friend auto operator/(SseLanes a, SseLanes b) -> SseLanes
+			{
+				return {_mm_div_ps(a.v, b.v)};
+			}
+
+			// lanes are transforms, so a column of all four is a transpose away
+			static void store(const SseLanes (&m)[4][3], float* out)
+			{
+				for (int column = 0; column < 4; column++)
+				{
+					__m128 x = m[column][0].v;
+					__m128 y = m[column][1].v;
+					__m128 z = m[column][2].v;
+					__m128 w = _mm_set1_ps(column == 3 ? 1.0F : 0.0F);
+					_MM_TRANSPOSE4_PS(x, y, z, w);
+
+					_mm_storeu_ps(out + 0 * 16 + column * 4, x);
+					_mm_storeu_ps(out + 1 * 16 + column * 4, y);
+					_mm_storeu_ps(out + 2 * 16 + column * 4, z);
+					_mm_storeu_ps(out + 3 * 16 + column * 4, w);
+				}
+			}
+
+			static void mulParent(const float* parent, float* matrix)
+			{
+				__m128 p0 = _mm_loadu_ps(parent + 0);
+				__m128 p1 = _mm_loadu_ps(parent + 4);
+				__m128 p2 = _mm_loadu_ps(parent + 8);
+				__m128 p3 = _mm_loadu_ps(parent + 12);
+
+				// each column of the result only needs the same column of the local one
+				for (int column = 0; column < 4; column++)
+				{
+					float* local = matrix + column * 4;
+					__m128 result = _mm_mul_ps(p0, _mm_set1_ps(local[0]));
+					result = _mm_add_ps(result, _mm_mul_ps(p1, _mm_set1_ps(local[1])));
+					result = _mm_add_ps(result, _mm_mul_ps(p2, _mm_set1_ps(local[2])));
+					result = _mm_add_ps(result, _mm_mul_ps(p3, _mm_set1_ps(local[3])));
+					_mm_storeu_ps(local, result);
+				}
+			}
+		};
+
+		auto hasAvx2() -> bool
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+			{
+				return false;
+			}
+
+			// the os has to save ymm registers too, not just the cpu support them
+			__cpuid(info, 1);
+			bool fma = (info[2] & (1 << 12)) != 0;
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			if (!fma || !osxsave || (_xgetbv(0) & 6) != 6)
+			{
+				return false;
+			}
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+		}
+#endif
+
+#ifdef ES_SIMD_NEON
+		struct NeonLanes
+		{
+			static constexpr size_t Width = 4;
+			float32x4_t v;
+
+			static auto load(const float* p) -> NeonLanes
+			{
+				return {vld1q_f32(p)};
+			}
+			static auto set(float value) -> NeonLanes
+			{
+				return {vdupq_n_f32(value)};
+			}
+			static auto sqrt(NeonLanes a) -> NeonLanes
+			{
+				return {vsqrtq_f32(a.v)};
+			}
+			static auto max(NeonLanes a, NeonLanes b) -> NeonLanes
+			{
+				return {vmaxq_f32(a.v, b.v)};
+			}
+
+			friend auto operator+(NeonLanes a, NeonLanes b) -> NeonLanes
+			{
+				return {vaddq_f32(a.v, b.v)};
+			}
+			friend auto operator-(NeonLanes a, NeonLanes b) -> NeonLanes
+			{
+				return {vsubq_f32(a.v, b.v)};
+			}
+			friend auto operator*(NeonLanes a, NeonLanes b) -> NeonLanes
+			{
+				return {vmulq_f32(a.v, b.v)};
+			}
+			friend auto operator/(NeonLanes a, NeonLanes b) -> NeonLanes
+			{
+				return {vdivq_f32(a.v, b.v)};
+			}
+
+			static void store(const NeonLanes (&m)[4][3], float* out)
+			{
+				for (int column = 0; column < 4; column++)
+				{
+					float32x4x2_t xy = vtrnq_f32(m[column][0].v, m[column][1].v);
+					float32x4x2_t zw =
+						vtrnq_f32(m[column][2].v, vdupq_n_f32(column == 3 ? 1.0F : 0.0F));
+
+					vst1q_f32(out + 0 * 16 + column * 4,
+							  vcombine_f32(vget_low_f32(xy.val[0]), vget_low_f32(zw.val[0])));
+					vst1q_f32(out + 1 * 16 + column * 4,
+							  vcombine_f32(vget_low_f32(xy.val[1]), vget_low_f32(zw.val[1])));
+					vst1q_f32(out + 2 * 16 + column * 4,
+							  vcombine_f32(vget_high_f32(xy.val[0]), vget_high_f32(zw.val[0])));
+					vst1q_f32(out + 3 * 16 + column * 4,
+							  vcombine_f32(vget_high_f32(xy.val[1]), vget_high_f32(zw.val[1])));
+				}
+			}
+
+			static void mulParent(const float* parent, float* matrix)
+			{
+				float32x4_t p0 = vld1q_f32(parent + 0);
+				float32x4_t p1 = vld1q_f32(parent + 4);
+				float32x4_t p2 = vld1q_f32(parent + 8);
+				float32x4_t p3 = vld1q_f32(parent + 12);
+
+				for (int column = 0; column < 4; column++)
+				{
+					float32x4_t local = vld1q_f32(matrix + column * 4);
+					float32x4_t result = vmulq_laneq_f32(p0, local, 0);
+					result = vfmaq_laneq_f32(result, p1, local, 1);
+					result = vfmaq_laneq_f32(result, p2, local, 2);
+					result = vfmaq_laneq_f32(result, p3, local, 3);
+					vst1q_f32(matrix + column * 4, result);
+				}
+			}
+		};
+#endif
+
+		using Kernel = auto (*)(const TransformStreams&, const Matrix4* const*, Matrix4*, size_t)
+			-> size_t;
+
+		struct KernelChoice
+		{
+			Kernel kernel;
+			size_t width;
+		};
+
+		auto selectKernel() -> KernelChoice
+		{
+#if defined(ES_SIMD_X86)
+			if (hasAvx2())
+			{
+				return {&internals::composeTransformsAvx2, 8};
+			}
+			return {&internals::composeTransforms<SseLanes>, 4};
+#elif defined(ES_SIMD_NEON)
+			return {&internals::composeTransforms<NeonLanes>, 4};
+#else
+			return {&internals::composeTransforms<ScalarLanes>, 1};
+#endif
+		}
+
+		auto getKernel() -> const KernelChoice&
+		{
+			static const KernelChoice choice = selectKernel();
+			return choice;
+		}
+
+		auto advance(const TransformStreams& local, size_t count) -> TransformStreams
+		{
+			return {local.positionX + count, local.positionY + count, local.positionZ + count,
+					local.rotationX + count, local.rotationY + count, local.rotationZ + count,
+					local.rotationW + count, local.scaleX + count,	  local.scaleY + count,
+					local.scaleZ + count};
+		}
+	}
+
+	auto composeTRS(const Vector3& position, const Quaternion& rotation, const Vector3& scale)
+		-> Matrix4
+	{
+		TransformStreams local{&position.x, &position.y, &position.z, &rotation.x, &rotation.y,
+							   &rotation.z, &rotation.w, &scale.x,	  &scale.y,	   &scale.z};
+
+		Matrix4 result;
+		internals::composeTransforms<ScalarLanes>(local, nullptr, &result, 1);
+		return result;
+	}
+
+	void composeLocalMatrices(const TransformStreams& local, Matrix4* out, size_t count)
+	{
+		composeWorldMatrices(local, nullptr, out, count);
+	}
+
+	void composeWorldMatrices(const TransformStreams& local, const Matrix4* const* parents,
+							  Matrix4* out, size_t count)
+	{
+		size_t done = getKernel().kernel(local, parents, out, count);
+		if (done == count)
+		{
+			return;
+		}
+
+		internals::composeTransforms<ScalarLanes>(advance(local, done),
+												  parents != nullptr ? parents + done : nullptr,
+												  out + done, count - done);
+	}
+
+	auto getTransformBatchWidth() -> size_t
+	{
+		return getKernel().width;
+	}
+
+	void TransformBatch::resize(size_t count)
+	{
+		for (auto& stream : _streams)
+		{
+			stream.resize(count);
+		}
+
+		// scale and rotation start out as identity, not zero
+		for (size_t i = _count; i < count; i++)
+		{
+			_streams[RotationW][i] = 1.0F;
+			_streams[ScaleX][i] = 1.0F;
+			_streams[ScaleY][i] = 1.0F;
+			_streams[ScaleZ][i] = 1.0F;
+		}
+
+		_count = count;
+	}
+
+	void TransformBatch::set(size_t index, const Vector3& position, const Quaternion& rotation,
+							 const Vector3& scale)
+	{
+		_streams[PositionX][index] = position.x;
+		_streams[PositionY][index] = position.y;
+		_streams[PositionZ][index] = position.z;
+		_streams[RotationX][index] = rotation.x;
+		_streams[RotationY][index] = rotation.y;
+		_streams[RotationZ][index] = rotation.z;
+		_streams[RotationW][index] = rotation.w;
+		_streams[ScaleX][index] = scale.x;
+		_streams[ScaleY][index] = scale.y;
+		_streams[ScaleZ][index] = scale.z;
+	}
+
+	auto TransformBatch::getStreams() const -> TransformStreams
+	{
+		return {_streams[PositionX].data(), _streams[PositionY].data(), _streams[PositionZ].data(),
+				_streams[RotationX].data(), _streams[RotationY].data(), _streams[RotationZ].data(),
+				_streams[RotationW].data(), _streams[ScaleX].data(),	_streams[ScaleY].data(),
+				_streams[ScaleZ].data()};
+	}
+}
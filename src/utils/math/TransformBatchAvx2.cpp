@@ -0,0 +1,104 @@
+// built with avx2 and fma enabled (see meson.build), and only ever called after a
+// cpu check. keep the includes down to the kernel header and intrinsics, anything
+// inline from elsewhere would get compiled with avx2 here too
+#include "utils/math/TransformKernel.h"
+#include <immintrin.h>
+
+namespace math
+{
+	namespace
+	{
+		struct Avx2Lanes
+		{
+			static constexpr size_t Width = 8;
+			__m256 v;
+
+			static auto load(const float* p) -> Avx2Lanes
+			{
+				return {_mm256_loadu_ps(p)};
+			}
+			static auto set(float value) -> Avx2Lanes
+			{
+				return {_mm256_set1_ps(value)};
+			}
+			static auto sqrt(Avx2Lanes a) -> Avx2Lanes
+			{
+				return {_mm256_sqrt_ps(a.v)};
+			}
+			static auto max(Avx2Lanes a, Avx2Lanes b) -> Avx2Lanes
+			{
+				return {_mm256_max_ps(a.v, b.v)};
+			}
+
+			friend auto operator+(Avx2Lanes a, Avx2Lanes b) -> Avx2Lanes
+			{
+				return {_mm256_add_ps(a.v, b.v)};
+			}
+			friend auto operator-(Avx2Lanes a, Avx2Lanes b) -> Avx2Lanes
+			{
+				return {_mm256_sub_ps(a.v, b.v)};
+			}
+			friend auto operator*(Avx2Lanes a, Avx2Lanes b) -> Avx2Lanes
+			{
+				return {_mm256_mul_ps(a.v, b.v)};
+			}
+			friend auto operator/(Avx2Lanes a, Avx2Lanes b) -> Avx2Lanes
+			{
+				return {_mm256_div_ps(a.v, b.v)};
+			}
+
+			// both 128 bit halves get transposed like the sse version, four transforms
+			// each
+			static void store(const Avx2Lanes (&m)[4][3], float* out)
+			{
+				for (int column = 0; column < 4; column++)
+				{
+					__m128 w = _mm_set1_ps(column == 3 ? 1.0F : 0.0F);
+
+					for (int half = 0; half < 2; half++)
+					{
+						__m128 x = half == 0 ? _mm256_castps256_ps128(m[column][0].v)
+											 : _mm256_extractf128_ps(m[column][0].v, 1);
+						__m128 y = half == 0 ? _mm256_castps256_ps128(m[column][1].v)
+											 : _mm256_extractf128_ps(m[column][1].v, 1);
+						__m128 z = half == 0 ? _mm256_castps256_ps128(m[column][2].v)
+											 : _mm256_extractf128_ps(m[column][2].v, 1);
+						__m128 last = w;
+						_MM_TRANSPOSE4_PS(x, y, z, last);
+
+						float* base = out + half * 4 * 16 + column * 4;
+						_mm_storeu_ps(base + 0 * 16, x);
+						_mm_storeu_ps(base + 1 * 16, y);
+						_mm_storeu_ps(base + 2 * 16, z);
+						_mm_storeu_ps(base + 3 * 16, last);
+					}
+				}
+			}
+
+			static void mulParent(const float* parent, float* matrix)
+			{
+				__m128 p0 = _mm_loadu_ps(parent + 0);
+				__m128 p1 = _mm_loadu_ps(parent + 4);
+				__m128 p2 = _mm_loadu_ps(parent + 8);
+				__m128 p3 = _mm_loadu_ps(parent + 12);
+
+				for (int column = 0; column < 4; column++)
+				{
+					float* local = matrix + column * 4;
+					__m128 result = _mm_mul_ps(p0, _mm_broadcast_ss(local + 0));
+					result = _mm_fmadd_ps(p1, _mm_broadcast_ss(local + 1), result);
+					result = _mm_fmadd_ps(p2, _mm_broadcast_ss(local + 2), result);
+					result = _mm_fmadd_ps(p3, _mm_broadcast_ss(local + 3), result);
+					_mm_storeu_ps(local, result);
+				}
+			}
+		};
+	}
+
+	auto internals::composeTransformsAvx2(const TransformStreams& local,
+										  const Matrix4* const* parents, Matrix4* out,
+										  size_t count) -> size_t
+	{
+		return composeTransforms<Avx2Lanes>(local, parents, out, count);
+	}
+}